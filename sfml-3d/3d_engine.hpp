@@ -20,9 +20,37 @@ static sf::Vector2f normalize_point(sf::RenderWindow& window,
 }
 
 float NEAR = 0.01f;
+float FAR_PLANE = 100000.0f;
+
+// Spheres whose projected radius is below this many pixels are not drawn
+float MIN_PROJECTED_RADIUS = 0.5f;
+
+// When set, spheres are drawn as shaded sprites from this atlas
+struct SphereAtlas;
+const SphereAtlas* SPHERE_SPRITES = nullptr;
 
 #include "Object3D.hpp"
 #include "Shape2D.hpp"
+#include "BSPTree3D.hpp"
+#include "Collection.hpp"
+#include "ObjectPool.hpp"
+#include "Wireframe3D.hpp"
+#include "Instance3D.hpp"
+#include "SceneGraph3D.hpp"
+#include "PointCloud3D.hpp"
+#include "Polyline3D.hpp"
+#include "Trail3D.hpp"
+#include "ParticleSystem3D.hpp"
+#include "Surface3D.hpp"
+#include "Curve3D.hpp"
+#include "Graph3D.hpp"
+#include "ForceLayout3D.hpp"
+#include "VoxelGrid3D.hpp"
+#include "Isosurface3D.hpp"
+#include "SphereClusters3D.hpp"
+#include "Sprite3D.hpp"
+#include "SphereView3D.hpp"
+#include "Primitives3D.hpp"
 
 // Helpers to make compatible with an older version of this library
 // NOTE: Not 100% compatible. Before it was sufficient only to pass a mat4. Now
@@ -45,6 +73,12 @@ void draw3DLine(sf::RenderWindow& window, vec4 a, vec4 b, Camera& camera,
 struct Object3D_Collection {
     std::vector<std::pair<int, Object3D*>> c;
 
+    // Scratch space reused every frame for the batched line distances
+    LineBatch line_batch;
+    bool lines_gathered = false;  // line_batch is current for this frame
+
+    Batcher2D batcher;
+
     auto& operator[](std::size_t index) { return c[index]; }
 
     void resetDistances() {
@@ -53,13 +87,57 @@ struct Object3D_Collection {
         }
     }
 
+    // Finds the lines in c. Done at most once per frame: depthSort gathers,
+    // clipLines reuses the result, and draw ends the frame. Changing c
+    // between those calls requires calling gatherLines again.
+    void gatherLines() {
+        line_batch.clear();
+        for (auto& pair : c) {
+            if (auto* line = dynamic_cast<Line3D*>(pair.second)) {
+                line_batch.add(line);
+            }
+        }
+        lines_gathered = true;
+    }
+
+    // Computes the distances of all lines in one pass instead of one virtual
+    // call per line while sorting
+    void computeLineDistances(const Camera& camera) {
+        if (!lines_gathered) gatherLines();
+        line_batch.computeDistances(camera);
+    }
+
+    // Frustum-clips all lines in one pass; call once per frame before drawing
+    void clipLines(const sf::RenderWindow& window, const Camera& camera) {
+        if (!lines_gathered) gatherLines();
+        line_batch.clip(window, camera);
+    }
+
     void depthSort(Camera& camera) {
         resetDistances();
+        gatherLines();
+        line_batch.computeDistances(camera);
         std::sort(c.begin(), c.end(), [&camera](const auto& a, const auto& b) {
             return a.second->getDistance(camera) >
                    b.second->getDistance(camera);
         });
     }
+
+    // Draws every object in order, batching consecutive shapes into as few
+    // draw calls as possible. colorOf(id) gives the color of each object.
+    template <typename ColorFn>
+    void draw(sf::RenderWindow& window, const Camera& camera, ColorFn colorOf) {
+        for (auto& [id, object] : c) {
+            object->draw(batcher, window, camera, colorOf(id));
+        }
+        batcher.flush(window);
+        lines_gathered = false;
+    }
+
+    void draw(sf::RenderWindow& window, const Camera& camera,
+              sf::Color color = sf::Color::White) {
+        draw(window, camera, [color](int) { return color; });
+    }
 };
 
 //Weird draw line from 3D to 2D point:
@@ -77,8 +155,8 @@ void draw3DLineTo2DPoint(sf::RenderWindow& window, vec4 a, sf::Vector2f b, Camer
 }
 
 
-// CUBE (basically a collection of 12 Line3D objects)
-std::array<vec4, 8> cubeVertices(vec4 center, float edge) {
+// CUBE (12 edges between 8 shared vertices)
+constexpr std::array<vec4, 8> cubeVertices(vec4 center, float edge) {
     float h = edge / 2.f;
 
     return {
@@ -93,8 +171,14 @@ std::array<vec4, 8> cubeVertices(vec4 center, float edge) {
     };
 }
 
-const int cubeEdges[12][2] = {
+constexpr std::array<std::array<int, 2>, 12> cubeEdges = {{
     {0, 1}, {1, 2}, {2, 3}, {3, 0},  // bottom face
     {4, 5}, {5, 6}, {6, 7}, {7, 4},  // top face
     {0, 4}, {1, 5}, {2, 6}, {3, 7}   // vertical edges
-};
+}};
+
+// The cube as a single Wireframe3D: 8 vertices transformed once per frame
+// instead of 12 separate Line3Ds
+Wireframe3D cubeWireframe(vec4 center, float edge, float thickness = 1.0f) {
+    return Wireframe3D(cubeVertices(center, edge), cubeEdges, thickness);
+}
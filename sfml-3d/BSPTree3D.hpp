@@ -0,0 +1,252 @@
+#pragma once
+/*
+BSP tree for static scenes: built once, then walked back-to-front every frame
+instead of depth sorting the whole collection
+*/
+
+#include <algorithm>
+#include <limits>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "3d_camera.hpp"
+#include "Object3D.hpp"
+#include "math4.hpp"
+
+// Splitting planes are axis aligned (x, y or z = split). At every node, 7
+// candidates per axis are taken at the 1/8 .. 7/8 quantiles of the objects'
+// extents along it, and the one with the lowest 4 * (objects cut) +
+// |front - back| wins. Lines that cross a plane are cut in two; the pieces
+// are owned by the tree and keep the original id.
+//
+// Splitting planes order lines and labels exactly; the result is only
+// approximate in two cases:
+// - A sphere can't be cut, so one crossing a plane stays at that node and is
+//   drawn between the two halves. Objects in the near half that it overlaps
+//   on screen are still drawn over it.
+// - Objects that share a node are ordered by their distance to the eye.
+//   Such a node is a leaf, a node whose split made no progress, or the root
+//   list of unsupported types (anything but lines, spheres and labels).
+// Those per-node lists are sorted on every traversal. A leaf holds at most
+// maxLeafSize objects (more only past maxDepth), so walking the tree stays
+// O(n) per frame for scenes that split cleanly. Scenes that keep many spheres
+// on one plane, or many unsupported objects, pay for sorting those lists
+// every frame.
+struct BSPTree3D {
+    using Entry = std::pair<int, Object3D*>;
+
+    struct Node {
+        int axis = -1;  // -1 for leaves
+        float split = 0.0f;
+        int front = -1, back = -1;  // indices into nodes
+
+        // Spheres crossing the splitting plane, or the leaf contents
+        std::vector<Entry> objects;
+    };
+
+    std::vector<Node> nodes;
+    std::vector<std::unique_ptr<Line3D>> fragments;
+
+    // Leaves hold at most this many objects (sorted by distance when traversed)
+    int maxLeafSize = 4;
+    int maxDepth = 24;
+
+    BSPTree3D() = default;
+    BSPTree3D(const std::vector<Entry>& objects) { build(objects); }
+
+    static float component(const vec4& v, int axis) {
+        return axis == 0 ? v.x : (axis == 1 ? v.y : v.z);
+    }
+
+    // Extent of an object along an axis. Returns false for unsupported types.
+    static bool extent(Object3D* obj, int axis, float& lo, float& hi) {
+        if (auto* line = dynamic_cast<Line3D*>(obj)) {
+            lo = std::min(component(line->a, axis), component(line->b, axis));
+            hi = std::max(component(line->a, axis), component(line->b, axis));
+        } else if (auto* sphere = dynamic_cast<Sphere3D*>(obj)) {
+            lo = component(sphere->position, axis) - sphere->radius;
+            hi = component(sphere->position, axis) + sphere->radius;
+        } else if (auto* label = dynamic_cast<Label3D*>(obj)) {
+            lo = hi = component(label->position, axis);
+        } else {
+            return false;
+        }
+        return true;
+    }
+
+    void build(const std::vector<Entry>& objects) {
+        nodes.clear();
+        fragments.clear();
+
+        std::vector<Entry> supported, other;
+        float lo, hi;
+        for (const Entry& e : objects) {
+            if (extent(e.second, 0, lo, hi))
+                supported.push_back(e);
+            else
+                other.push_back(e);
+        }
+
+        int root = buildNode(std::move(supported), 0);
+        Node& r = nodes[root];
+        r.objects.insert(r.objects.end(), other.begin(), other.end());
+    }
+
+    // Appends all objects to out, farthest first (painter's order)
+    void traverse(const Camera& camera, std::vector<Entry>& out) {
+        out.clear();
+        if (!nodes.empty()) traverseNode(0, camera.cf.get_position(), camera, out);
+    }
+
+    int buildNode(std::vector<Entry> objects, int depth) {
+        int index = static_cast<int>(nodes.size());
+        nodes.emplace_back();
+
+        if (static_cast<int>(objects.size()) <= maxLeafSize || depth >= maxDepth) {
+            nodes[index].objects = std::move(objects);
+            return index;
+        }
+
+        // Candidate planes at evenly spaced quantiles of the object bounds on each axis
+        // (planes that touch objects instead of going through them); pick the
+        // one that cuts the fewest lines while staying balanced
+        int axis = 0;
+        float split = 0.0f;
+        std::size_t best_cost = std::numeric_limits<std::size_t>::max();
+        std::vector<float> bounds(2 * objects.size());
+
+        for (int ax = 0; ax < 3; ax++) {
+            for (std::size_t i = 0; i < objects.size(); i++) {
+                extent(objects[i].second, ax, bounds[2 * i], bounds[2 * i + 1]);
+            }
+            std::sort(bounds.begin(), bounds.end());
+
+            for (int q = 1; q < 8; q++) {
+                float candidate = bounds[bounds.size() * q / 8];
+                std::size_t n_front = 0, n_back = 0, n_cut = 0;
+
+                for (const Entry& e : objects) {
+                    float lo, hi;
+                    extent(e.second, ax, lo, hi);
+                    if (lo >= candidate && hi > candidate)
+                        n_front++;
+                    else if (hi <= candidate)
+                        n_back++;
+                    else
+                        n_cut++;
+                }
+
+                // A plane with everything on one side splits nothing
+                if (n_front == objects.size() || n_back == objects.size()) continue;
+
+                std::size_t imbalance =
+                    n_front > n_back ? n_front - n_back : n_back - n_front;
+                std::size_t cost = 4 * n_cut + imbalance;
+                if (cost < best_cost) {
+                    best_cost = cost;
+                    axis = ax;
+                    split = candidate;
+                }
+            }
+        }
+
+        // Fragments only join the tree once the split is accepted
+        std::vector<Entry> front, back, on;
+        std::vector<std::unique_ptr<Line3D>> pieces;
+        for (const Entry& e : objects) {
+            float lo, hi;
+            extent(e.second, axis, lo, hi);
+
+            if (lo >= split && hi > split) {
+                front.push_back(e);
+            } else if (hi <= split) {
+                // Also takes objects lying in the plane: they can only be
+                // covered by the front half, which is drawn after them
+                back.push_back(e);
+            } else if (auto* line = dynamic_cast<Line3D*>(e.second)) {
+                splitLine(e.first, *line, axis, split, front, back, pieces);
+            } else {
+                on.push_back(e);
+            }
+        }
+
+        // No progress: everything crosses the plane, or landed uncut on one
+        // side (cut lines put a piece on each side, so sizes alone can't tell)
+        if (on.size() == objects.size() ||
+            (pieces.empty() &&
+             (front.size() == objects.size() || back.size() == objects.size()))) {
+            nodes[index].objects = std::move(objects);
+            return index;
+        }
+
+        for (auto& piece : pieces) fragments.push_back(std::move(piece));
+
+        nodes[index].axis = axis;
+        nodes[index].split = split;
+        nodes[index].objects = std::move(on);
+
+        // nodes may reallocate while building children, so no references here
+        int f = front.empty() ? -1 : buildNode(std::move(front), depth + 1);
+        nodes[index].front = f;
+        int b = back.empty() ? -1 : buildNode(std::move(back), depth + 1);
+        nodes[index].back = b;
+
+        return index;
+    }
+
+    static void splitLine(int id, const Line3D& line, int axis, float split,
+                          std::vector<Entry>& front, std::vector<Entry>& back,
+                          std::vector<std::unique_ptr<Line3D>>& pieces) {
+        vec4 a = line.a, b = line.b;
+        float ca = component(a, axis), cb = component(b, axis);
+        float t = (split - ca) / (cb - ca);
+        vec4 mid = a + (b - a) * t;
+
+        auto first = std::make_unique<Line3D>(a, mid, line.thickness);
+        auto second = std::make_unique<Line3D>(mid, b, line.thickness);
+
+        (ca > split ? front : back).push_back({id, first.get()});
+        (cb > split ? front : back).push_back({id, second.get()});
+
+        pieces.push_back(std::move(first));
+        pieces.push_back(std::move(second));
+    }
+
+    // Orders the objects sharing a node (see the note at the top)
+    static void sortByDistance(std::vector<Entry>& objects, const Camera& camera) {
+        if (objects.size() < 2) return;
+
+        std::vector<std::pair<float, Entry>> keyed;
+        for (const Entry& e : objects) {
+            keyed.push_back({e.second->calculateDistance(camera), e});
+        }
+        std::sort(keyed.begin(), keyed.end(), [](const auto& a, const auto& b) {
+            return a.first > b.first;
+        });
+        for (std::size_t i = 0; i < keyed.size(); i++) {
+            objects[i] = keyed[i].second;
+        }
+    }
+
+    void traverseNode(int index, const vec4& eye, const Camera& camera,
+                      std::vector<Entry>& out) {
+        Node& node = nodes[index];
+
+        if (node.axis < 0) {
+            sortByDistance(node.objects, camera);
+            out.insert(out.end(), node.objects.begin(), node.objects.end());
+            return;
+        }
+
+        // Whatever is on the far side of the plane can't cover the near side
+        bool eye_in_front = component(eye, node.axis) >= node.split;
+        int far_child = eye_in_front ? node.back : node.front;
+        int near_child = eye_in_front ? node.front : node.back;
+
+        if (far_child >= 0) traverseNode(far_child, eye, camera, out);
+        sortByDistance(node.objects, camera);
+        out.insert(out.end(), node.objects.begin(), node.objects.end());
+        if (near_child >= 0) traverseNode(near_child, eye, camera, out);
+    }
+};
@@ -0,0 +1,44 @@
+#pragma once
+/*
+Batcher2D: collects triangles from many shapes and draws them with as few
+draw calls as possible. Consecutive shapes using the same texture (or none)
+end up in the same vertex array, so drawing order is kept.
+*/
+
+#include <SFML/Graphics.hpp>
+#include <vector>
+
+struct Batcher2D {
+    struct Batch {
+        const sf::Texture* texture = nullptr;
+        sf::VertexArray vertices{sf::PrimitiveType::Triangles};
+    };
+
+    // Batches are kept between frames so their memory is reused
+    std::vector<Batch> batches;
+    std::size_t used = 0;
+
+    // Vertex array to append triangles drawn with the given texture
+    sf::VertexArray& get(const sf::Texture* texture = nullptr) {
+        if (used > 0 && batches[used - 1].texture == texture) {
+            return batches[used - 1].vertices;
+        }
+        if (used == batches.size()) batches.emplace_back();
+
+        Batch& batch = batches[used++];
+        batch.texture = texture;
+        batch.vertices.clear();
+        return batch.vertices;
+    }
+
+    // Draws everything collected so far
+    void flush(sf::RenderWindow& window) {
+        for (std::size_t i = 0; i < used; i++) {
+            if (batches[i].vertices.getVertexCount() == 0) continue;
+            window.draw(batches[i].vertices, sf::RenderStates(batches[i].texture));
+        }
+        used = 0;
+    }
+
+    std::size_t drawCalls() const { return used; }
+};
@@ -0,0 +1,221 @@
+#pragma once
+/*
+Collection<Ts...>: Object3D_Collection for when the object types are known at
+compile time. Objects are stored by value in one vector per type and every
+distance call is a direct (non-virtual) call, so the compiler can inline them.
+
+Drawing projects each type in its own loop. Types that declare a Shape type
+and a project() returning std::optional<Shape> (Sphere3D, Line3D) are
+projected into a per-type buffer of 2D shapes held by value, with no heap
+allocation or virtual call; other types fall back to computeShape. The sorted
+keys then only pick shapes out of those buffers, and everything goes through
+one Batcher2D.
+
+    Collection<Sphere3D, Line3D, Label3D> scene;
+    scene.add(Sphere3D(vec4(0, 0, 0), 10));
+    ...
+    scene.depthSort(camera);
+    scene.draw(window, camera);
+*/
+
+#include <SFML/Graphics.hpp>
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "3d_camera.hpp"
+#include "Batcher2D.hpp"
+#include "Object3D.hpp"
+#include "Shape2D.hpp"
+
+// Projected 2D shape of a T: held by value when T has a project(), otherwise
+// whatever computeShape returns
+template <typename T, typename = void>
+struct ProjectedShapeOf {
+    using type = std::unique_ptr<Shape2D>;
+};
+
+template <typename T>
+struct ProjectedShapeOf<T, std::void_t<typename T::Shape>> {
+    using type = std::optional<typename T::Shape>;
+};
+
+template <typename... Ts>
+struct Collection {
+    std::tuple<std::vector<Ts>...> items;
+
+    // Filled by draw, one entry per object of each type
+    std::tuple<std::vector<typename ProjectedShapeOf<Ts>::type>...> shapes;
+    Batcher2D batcher;
+
+    // One entry per object, sorted farthest first by depthSort
+    struct Key {
+        float distance;
+        std::uint32_t type;  // index into Ts...
+        std::uint32_t index;
+    };
+    std::vector<Key> order;
+
+    // Number of objects of each type when order was built; order is only
+    // used while they all still match
+    std::array<std::size_t, sizeof...(Ts)> order_counts{};
+
+    // Objects can be added or removed through this vector too; draw notices
+    // when the count of any type changed since depthSort
+    template <typename T>
+    std::vector<T>& get() {
+        return std::get<std::vector<T>>(items);
+    }
+
+    template <typename T>
+    T& add(T object) {
+        auto& v = get<T>();
+        v.push_back(std::move(object));
+        return v.back();
+    }
+
+    std::size_t size() const {
+        return std::apply([](const auto&... v) { return (v.size() + ...); },
+                          items);
+    }
+
+    void clear() {
+        std::apply([](auto&... v) { (v.clear(), ...); }, items);
+        order.clear();
+    }
+
+    std::array<std::size_t, sizeof...(Ts)> counts() const {
+        return std::apply(
+            [](const auto&... v) {
+                return std::array<std::size_t, sizeof...(Ts)>{v.size()...};
+            },
+            items);
+    }
+
+    void depthSort(const Camera& camera) {
+        order.clear();
+        order.reserve(size());
+        appendKeys(camera, std::index_sequence_for<Ts...>{});
+        order_counts = counts();
+
+        std::sort(order.begin(), order.end(), [](const Key& a, const Key& b) {
+            return a.distance > b.distance;
+        });
+    }
+
+    // colorOf(const T& object, std::size_t index) -> sf::Color, where index is
+    // the position of the object in get<T>()
+    template <typename ColorFn>
+    void draw(sf::RenderWindow& window, const Camera& camera, ColorFn colorOf) {
+        // After objects were added or removed since the last depthSort,
+        // everything is drawn unsorted
+        if (order_counts != counts()) {
+            order.clear();
+            appendUnsorted(std::index_sequence_for<Ts...>{});
+            order_counts = counts();
+        }
+
+        projectAll(window, camera, std::index_sequence_for<Ts...>{});
+
+        for (const Key& key : order) {
+            drawKey(window, key, colorOf, std::index_sequence_for<Ts...>{});
+        }
+        batcher.flush(window);
+    }
+
+    void draw(sf::RenderWindow& window, const Camera& camera,
+              sf::Color color = sf::Color::White) {
+        draw(window, camera, [color](const auto&, std::size_t) { return color; });
+    }
+
+    // Qualified calls (object.T::f) skip the vtable even though the member
+    // functions are virtual in Object3D
+    template <std::size_t I>
+    void appendKeysOf(const Camera& camera) {
+        using T = std::tuple_element_t<I, std::tuple<Ts...>>;
+        auto& v = std::get<I>(items);
+
+        for (std::size_t i = 0; i < v.size(); i++) {
+            order.push_back({v[i].T::calculateDistance(camera),
+                             static_cast<std::uint32_t>(I),
+                             static_cast<std::uint32_t>(i)});
+        }
+    }
+
+    template <std::size_t... Is>
+    void appendKeys(const Camera& camera, std::index_sequence<Is...>) {
+        (appendKeysOf<Is>(camera), ...);
+    }
+
+    template <std::size_t... Is>
+    void appendUnsorted(std::index_sequence<Is...>) {
+        auto appendType = [this](std::size_t type, std::size_t count) {
+            for (std::size_t i = 0; i < count; i++) {
+                order.push_back({0.0f, static_cast<std::uint32_t>(type),
+                                 static_cast<std::uint32_t>(i)});
+            }
+        };
+        (appendType(Is, std::get<Is>(items).size()), ...);
+    }
+
+    // One tight loop per type, into that type's shape buffer
+    template <std::size_t I>
+    void projectType(sf::RenderWindow& window, const Camera& camera) {
+        using T = std::tuple_element_t<I, std::tuple<Ts...>>;
+        auto& v = std::get<I>(items);
+        auto& out = std::get<I>(shapes);
+
+        out.resize(v.size());
+        for (std::size_t i = 0; i < v.size(); i++) {
+            if constexpr (std::is_same_v<typename ProjectedShapeOf<T>::type,
+                                         std::unique_ptr<Shape2D>>) {
+                out[i] = v[i].T::computeShape(window, camera);
+            } else {
+                out[i] = v[i].T::project(window, camera);
+            }
+        }
+    }
+
+    template <std::size_t... Is>
+    void projectAll(sf::RenderWindow& window, const Camera& camera,
+                    std::index_sequence<Is...>) {
+        (projectType<Is>(window, camera), ...);
+    }
+
+    // Shapes held by value are called directly; the others go through Shape2D
+    template <typename S>
+    void drawShape(sf::RenderWindow& window, std::optional<S>& shape, sf::Color color) {
+        if (!shape) return;
+        if (!shape->S::appendTo(batcher, color)) {
+            batcher.flush(window);
+            shape->S::draw(window, color);
+        }
+    }
+
+    void drawShape(sf::RenderWindow& window, std::unique_ptr<Shape2D>& shape,
+                   sf::Color color) {
+        if (!shape) return;
+        if (!shape->appendTo(batcher, color)) {
+            batcher.flush(window);
+            shape->draw(window, color);
+        }
+    }
+
+    template <std::size_t I, typename ColorFn>
+    void drawOne(sf::RenderWindow& window, std::size_t index, ColorFn& colorOf) {
+        drawShape(window, std::get<I>(shapes)[index],
+                  colorOf(std::get<I>(items)[index], index));
+    }
+
+    template <typename ColorFn, std::size_t... Is>
+    void drawKey(sf::RenderWindow& window, const Key& key, ColorFn& colorOf,
+                 std::index_sequence<Is...>) {
+        ((key.type == Is ? drawOne<Is>(window, key.index, colorOf) : void()), ...);
+    }
+};
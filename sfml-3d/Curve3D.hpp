@@ -0,0 +1,153 @@
+#pragma once
+/*
+Curve3D: a parametric curve p(t), t in [t0, t1], tessellated for the current
+camera. Pieces of the curve are split until the midpoint of every segment is
+within tolerance pixels of the real curve on screen, so far-away curves use
+few segments and close-up ones stay smooth. The result is drawn as a
+Polyline3D and reused until the camera has moved or turned noticeably.
+
+    Curve3D helix([](float t) { return vec4(cos(t) * 50, sin(t) * 50, t * 5); },
+                  0.0f, 60.0f);
+*/
+
+#include <SFML/Graphics.hpp>
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "3d_camera.hpp"
+#include "Frustum.hpp"
+#include "Object3D.hpp"
+#include "Polyline3D.hpp"
+#include "ProjectedVertices.hpp"
+#include "Shape2D.hpp"
+#include "math4.hpp"
+
+struct Curve3D : Object3D {
+    std::function<vec4(float)> f;
+    float t0 = 0.0f, t1 = 1.0f;
+
+    float tolerance = 0.5f;     // allowed screen-space error, in pixels
+    int initialSegments = 16;   // uniform pieces before any splitting
+    int maxSegments = 4096;     // cap on the segments of one tessellation
+
+    // The tessellation is redone when the camera moves by more than this
+    // fraction of its distance to the curve, turns by more than this many
+    // radians (pieces behind it were left coarse), or the FOV / window changes
+    float retessellateFraction = 0.1f;
+
+    Polyline3D polyline;  // current tessellation
+
+    ViewKey cache_key;  // view of the current tessellation
+
+    struct Piece {
+        float a, b;
+        vec4 pa, pb, pm;  // endpoints and midpoint on the curve
+        float error;      // screen distance of pm from the chord's midpoint
+        bool operator<(const Piece& other) const { return error < other.error; }
+    };
+
+    Curve3D() = default;
+    Curve3D(std::function<vec4(float)> fn, float a = 0.0f, float b = 1.0f,
+            float thickness = 1.0f)
+        : f(std::move(fn)), t0(a), t1(b) {
+        polyline.thickness = thickness;
+        polyline.chunkSize = 0;
+    }
+
+    // Call after changing f, t0 or t1
+    void markDirty() { cache_key.invalidate(); }
+
+    bool needsTessellation(sf::RenderWindow& window, const Camera& camera) const {
+        if (!cache_key.sameProjection(window, camera)) return true;
+        if (cache_key.turnSince(camera) > retessellateFraction) return true;
+
+        vec4 eye = camera.cf.get_position();
+        float moved = (eye - cache_key.cf.get_position()).magnitude();
+        float distance = std::max(polyline.radius > 0.0f
+                                      ? (eye - polyline.center).magnitude() - polyline.radius
+                                      : 0.0f,
+                                  NEAR);
+        return moved > retessellateFraction * distance;
+    }
+
+    void tessellate(sf::RenderWindow& window, const Camera& camera) {
+        const mat4 inv = camera.cf.inverse_rigid();
+        const float min_length = (t1 - t0) * 1e-5f;
+
+        auto error = [&](Piece& piece) {
+            mat4 m = inv;
+            vec4 a = m * piece.pa, b = m * piece.pb, c = m * piece.pm;
+
+            bool a_in = a.z >= NEAR, b_in = b.z >= NEAR, c_in = c.z >= NEAR;
+            if (!a_in && !b_in && !c_in) {
+                piece.error = 0.0f;  // behind the camera
+            } else if (!a_in || !b_in || !c_in) {
+                // Crosses the near plane: refine so the clipped end is accurate
+                piece.error = piece.b - piece.a > min_length ? tolerance * 4.0f : 0.0f;
+            } else {
+                sf::Vector2f a_ = ProjectedVertices::project(window, camera, a);
+                sf::Vector2f b_ = ProjectedVertices::project(window, camera, b);
+                sf::Vector2f c_ = ProjectedVertices::project(window, camera, c);
+                piece.error = magnitude(c_ - (a_ + b_) / 2.0f);
+            }
+        };
+
+        auto makePiece = [&](float a, float b, vec4 pa, vec4 pb) {
+            Piece piece{a, b, pa, pb, f((a + b) / 2.0f), 0.0f};
+            error(piece);
+            return piece;
+        };
+
+        // Split the worst piece first, so the cap leaves out the least
+        // visible detail
+        std::vector<Piece> heap;
+        int n = std::max(initialSegments, 1);
+        vec4 prev = f(t0);
+        for (int i = 0; i < n; i++) {
+            float a = t0 + (t1 - t0) * i / n, b = t0 + (t1 - t0) * (i + 1) / n;
+            vec4 next = f(b);
+            heap.push_back(makePiece(a, b, prev, next));
+            prev = next;
+        }
+        std::make_heap(heap.begin(), heap.end());
+
+        while (static_cast<int>(heap.size()) < maxSegments &&
+               heap.front().error > tolerance) {
+            std::pop_heap(heap.begin(), heap.end());
+            Piece piece = heap.back();
+            heap.pop_back();
+
+            float mid = (piece.a + piece.b) / 2.0f;
+            heap.push_back(makePiece(piece.a, mid, piece.pa, piece.pm));
+            std::push_heap(heap.begin(), heap.end());
+            heap.push_back(makePiece(mid, piece.b, piece.pm, piece.pb));
+            std::push_heap(heap.begin(), heap.end());
+        }
+
+        std::sort(heap.begin(), heap.end(),
+                  [](const Piece& x, const Piece& y) { return x.a < y.a; });
+
+        polyline.vertices.clear();
+        polyline.vertices.push_back(heap.front().pa);
+        for (const Piece& piece : heap) polyline.vertices.push_back(piece.pb);
+        polyline.markDirty();
+
+        cache_key.set(window, camera);
+    }
+
+    float calculateDistance(const Camera& camera) override {
+        if (!cache_key.valid) return (camera.cf.get_position() - f((t0 + t1) / 2.0f)).magnitude();
+        return polyline.calculateDistance(camera);
+    }
+
+    std::unique_ptr<Shape2D> computeShape(sf::RenderWindow& window,
+                                          const Camera& camera) override {
+        if (!f || t1 <= t0) return nullptr;
+        if (needsTessellation(window, camera)) tessellate(window, camera);
+        return polyline.computeShape(window, camera);
+    }
+};
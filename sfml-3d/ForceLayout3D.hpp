@@ -0,0 +1,202 @@
+#pragma once
+/*
+ForceLayout3D: force-directed layout that moves the nodes of a Graph3D.
+Nodes repel each other (Barnes–Hut: far-away groups of nodes act as one body
+at their center of mass), edges pull their nodes towards springLength, and a
+weak pull keeps the graph centered. Repulsion is computed on several threads.
+
+The layout is incremental: update() runs iterationsPerFrame steps, so it can
+be called every frame and the graph settles while it is being drawn. The
+step size shrinks (cooling) until the layout stops.
+
+    ForceLayout3D layout(&graph);
+    while (window.isOpen()) {
+        layout.update();
+        ...
+    }
+*/
+
+#include <algorithm>
+#include <array>
+#include <limits>
+#include <vector>
+
+#include "Graph3D.hpp"
+#include "OctreePartition.hpp"
+#include "Parallel.hpp"
+#include "math4.hpp"
+
+struct ForceLayout3D {
+    Graph3D* graph;
+
+    float repulsion = 2000.0f;     // strength of node-node repulsion
+    float springLength = 30.0f;    // rest length of edges
+    float springStrength = 0.05f;
+    float centering = 0.001f;      // pull towards the origin
+    float theta = 0.8f;            // Barnes–Hut accuracy (0 = exact)
+
+    float temperature = 10.0f;     // largest move of a node in one step
+    float cooling = 0.99f;         // temperature factor per step
+    float minTemperature = 0.01f;  // the layout stops below this
+    int iterationsPerFrame = 1;
+
+    struct Node {
+        vec4 center;      // of the node's cube
+        float half;
+        vec4 mass_center; // center of mass of the bodies inside
+        float mass;
+        int begin, end;   // range in order
+        std::array<int, 8> children;
+    };
+    std::vector<Node> nodes;
+    std::vector<int> order;  // node indices grouped by octree node
+    std::vector<int> scratch;
+    std::vector<vec4> force;
+    int leafSize = 8;
+
+    ForceLayout3D(Graph3D* g) : graph(g) {}
+
+    bool running() const { return temperature > minTemperature; }
+
+    // Restarts a settled layout (e.g. after adding nodes)
+    void reheat(float t = 10.0f) { temperature = t; }
+
+    // Runs up to iterationsPerFrame steps; returns whether the layout is
+    // still moving
+    bool update() {
+        for (int i = 0; i < iterationsPerFrame && running(); i++) step();
+        return running();
+    }
+
+    void buildTree() {
+        const std::vector<vec4>& p = graph->positions;
+        const int n = static_cast<int>(p.size());
+
+        nodes.clear();
+        order.resize(n);
+        scratch.resize(n);
+        for (int i = 0; i < n; i++) order[i] = i;
+        if (n == 0) return;
+
+        const float big = std::numeric_limits<float>::max();
+        vec4 lo(big, big, big), hi(-big, -big, -big);
+        for (const vec4& v : p) {
+            lo = vec4(std::min(lo.x, v.x), std::min(lo.y, v.y), std::min(lo.z, v.z));
+            hi = vec4(std::max(hi.x, v.x), std::max(hi.y, v.y), std::max(hi.z, v.z));
+        }
+        vec4 center = (lo + hi) * 0.5f;
+        float half = std::max({hi.x - lo.x, hi.y - lo.y, hi.z - lo.z}) * 0.5f + 1e-3f;
+
+        buildNode(center, half, 0, n, 0);
+    }
+
+    int buildNode(vec4 center, float half, int begin, int end, int depth) {
+        const std::vector<vec4>& p = graph->positions;
+
+        int index = static_cast<int>(nodes.size());
+        Node node{center, half, vec4(), 0.0f, begin, end, {}};
+        node.children.fill(-1);
+        nodes.push_back(node);
+
+        if (end - begin <= leafSize || depth >= 20) {
+            vec4 sum;
+            for (int i = begin; i < end; i++) sum += p[order[i]];
+            nodes[index].mass = static_cast<float>(end - begin);
+            nodes[index].mass_center = sum / nodes[index].mass;
+            return index;
+        }
+
+        std::array<int, 9> start = partitionOctants(p, center, begin, end, order, scratch);
+
+        vec4 weighted;
+        float mass = 0.0f;
+        for (int o = 0; o < 8; o++) {
+            int b = begin + start[o], e = begin + start[o + 1];
+            if (b == e) continue;
+
+            int child =
+                buildNode(octantCenter(center, half, o), half / 2.0f, b, e, depth + 1);
+            nodes[index].children[o] = child;
+
+            weighted += nodes[child].mass_center * nodes[child].mass;
+            mass += nodes[child].mass;
+        }
+        nodes[index].mass = mass;
+        nodes[index].mass_center = weighted / mass;
+        return index;
+    }
+
+    // Repulsion on body i from the whole tree
+    vec4 repulsionOn(int i) {
+        const std::vector<vec4>& p = graph->positions;
+        vec4 pi = p[i];
+        vec4 f;
+
+        int stack[8 * 24];
+        int top = 0;
+        stack[top++] = 0;
+
+        auto push = [&](vec4 from, float mass) {
+            vec4 d = pi - from;
+            float d2 = d.magnitudeSquared() + 0.01f;  // softened
+            f += d * (repulsion * mass / (d2 * std::sqrt(d2)));
+        };
+
+        while (top > 0) {
+            const Node& node = nodes[stack[--top]];
+            vec4 d = pi - node.mass_center;
+            float d2 = d.magnitudeSquared();
+            float size = 2.0f * node.half;
+
+            bool leaf = true;
+            for (int child : node.children) leaf &= child < 0;
+
+            if (!leaf && size * size < theta * theta * d2) {
+                push(node.mass_center, node.mass);
+            } else if (leaf) {
+                for (int k = node.begin; k < node.end; k++) {
+                    if (order[k] != i) push(p[order[k]], 1.0f);
+                }
+            } else {
+                for (int child : node.children) {
+                    if (child >= 0) stack[top++] = child;
+                }
+            }
+        }
+        return f;
+    }
+
+    void step() {
+        std::vector<vec4>& p = graph->positions;
+        const std::size_t n = p.size();
+        if (n == 0) return;
+
+        buildTree();
+        force.resize(n);
+
+        parallelFor(0, n, [&](std::size_t b, std::size_t e) {
+            for (std::size_t i = b; i < e; i++) {
+                vec4 pi = p[i];
+                force[i] = repulsionOn(static_cast<int>(i)) - pi * centering;
+            }
+        }, 1024);
+
+        for (const auto& edge : graph->edges) {
+            vec4 d = p[edge[1]] - p[edge[0]];
+            float length = std::max(d.magnitude(), 1e-3f);
+            vec4 f = d * (springStrength * (length - springLength) / length);
+            force[edge[0]] += f;
+            force[edge[1]] -= f;
+        }
+
+        // Every node moves along its force, by at most temperature
+        for (std::size_t i = 0; i < n; i++) {
+            float length = force[i].magnitude();
+            if (length > temperature) force[i] *= temperature / length;
+            p[i] += force[i];
+        }
+
+        temperature *= cooling;
+        graph->markDirty();
+    }
+};
@@ -0,0 +1,136 @@
+#pragma once
+/*
+View frustum of a Camera, used for clipping before projection
+*/
+
+#include <SFML/Graphics.hpp>
+#include <algorithm>
+#include <cmath>
+
+#include "3d_camera.hpp"
+#include "math4.hpp"
+
+// All six planes are expressed in view (camera) space, where projecting is
+// just x' = FOV * x / z. A point is inside when every plane function is >= 0:
+//   near:   z - near            far:    far - z
+//   left:   x + kx * z          right:  kx * z - x
+//   bottom: y + ky * z          top:    ky * z - y
+// This is the same test as clip space -w <= x <= w, without the divide.
+struct Frustum {
+    float kx, ky;
+    float near, far;
+
+    // margin (in pixels) widens the sides so thick lines whose center is
+    // just off screen still get drawn
+    Frustum(const sf::RenderWindow& window, const Camera& camera,
+            float near_, float far_, float margin = 0.0f)
+        : near(near_), far(far_) {
+        float half_width = window.getSize().x / 2.0f + margin;
+        float half_height = window.getSize().y / 2.0f + margin;
+        kx = half_width / camera.FOV;
+        ky = half_height / camera.FOV;
+    }
+
+    bool containsPoint(vec4 p) const {
+        return p.z >= near && p.z <= far && std::abs(p.x) <= kx * p.z &&
+               std::abs(p.y) <= ky * p.z;
+    }
+
+    // Conservative test for a view-space sphere (may keep a few spheres that
+    // are just outside a corner of the frustum)
+    bool intersectsSphere(vec4 c, float r) const {
+        float rx = r * std::sqrt(1.0f + kx * kx);
+        float ry = r * std::sqrt(1.0f + ky * ky);
+        return c.z + r >= near && c.z - r <= far &&
+               std::abs(c.x) <= kx * c.z + rx && std::abs(c.y) <= ky * c.z + ry;
+    }
+
+    // Liang–Barsky: shrinks [t0, t1] so that a + t (b - a) stays on the inner
+    // side of the plane whose values at a and b are fa and fb.
+    // Returns false when the segment is entirely outside the plane.
+    static bool clipAgainstPlane(float fa, float fb, float& t0, float& t1) {
+        if (fa < 0 && fb < 0) return false;
+
+        if (fa < 0) {
+            t0 = std::max(t0, fa / (fa - fb));
+        } else if (fb < 0) {
+            t1 = std::min(t1, fa / (fa - fb));
+        }
+        return t0 <= t1;
+    }
+
+    // Clips a view-space segment in place. Returns false if nothing is left.
+    bool clipSegment(vec4& a, vec4& b) const {
+        float t0 = 0.0f, t1 = 1.0f;
+
+        if (!clipAgainstPlane(a.z - near, b.z - near, t0, t1) ||
+            !clipAgainstPlane(far - a.z, far - b.z, t0, t1) ||
+            !clipAgainstPlane(a.x + kx * a.z, b.x + kx * b.z, t0, t1) ||
+            !clipAgainstPlane(kx * a.z - a.x, kx * b.z - b.x, t0, t1) ||
+            !clipAgainstPlane(a.y + ky * a.z, b.y + ky * b.z, t0, t1) ||
+            !clipAgainstPlane(ky * a.z - a.y, ky * b.z - b.y, t0, t1))
+            return false;
+
+        vec4 d = b - a;
+        b = a + d * t1;
+        a = a + d * t0;
+        return true;
+    }
+
+    // Branch-free version of clipAgainstPlane for the batched (SoA) clipper;
+    // a fully rejected segment ends up with t0 > t1
+    static void clipAgainstPlaneBatch(float fa, float fb, float& t0,
+                                      float& t1) {
+        float t = fa / (fa - fb);
+        float lo = std::max(t0, t), hi = std::min(t1, t);
+        bool reject = (fa < 0) & (fb < 0);
+
+        t0 = fa < 0 ? lo : t0;
+        t1 = fb < 0 ? hi : t1;
+        t0 = reject ? 2.0f : t0;
+    }
+};
+
+// Identifies the view (camera frame, FOV and window size) a cached
+// projection was made with, so it is only recomputed when the view changes
+struct ViewKey {
+    mat4 cf;
+    float FOV = 0.0f;
+    sf::Vector2u size;
+    bool valid = false;
+
+    bool matches(const sf::RenderWindow& window, const Camera& camera) const {
+        if (!valid || FOV != camera.FOV || size != window.getSize()) return false;
+        for (int i = 0; i < 16; i++) {
+            if (cf.m[i] != camera.cf.m[i]) return false;
+        }
+        return true;
+    }
+
+    void set(const sf::RenderWindow& window, const Camera& camera) {
+        cf = camera.cf;
+        FOV = camera.FOV;
+        size = window.getSize();
+        valid = true;
+    }
+
+    void invalidate() { valid = false; }
+
+    // Same FOV and window size; the camera frame is not compared
+    bool sameProjection(const sf::RenderWindow& window, const Camera& camera) const {
+        return valid && FOV == camera.FOV && size == window.getSize();
+    }
+
+    // How far the camera's axes have turned since set(): the largest distance
+    // between an old and a new unit axis (about the angle in radians)
+    float turnSince(const Camera& camera) const {
+        float worst = 0.0f;
+        for (int c = 0; c < 3; c++) {
+            float dx = cf.m[4 * c] - camera.cf.m[4 * c];
+            float dy = cf.m[4 * c + 1] - camera.cf.m[4 * c + 1];
+            float dz = cf.m[4 * c + 2] - camera.cf.m[4 * c + 2];
+            worst = std::max(worst, dx * dx + dy * dy + dz * dz);
+        }
+        return std::sqrt(worst);
+    }
+};
@@ -0,0 +1,141 @@
+#pragma once
+/*
+Graph3D: nodes (drawn as spheres) connected by edges that refer to them by
+index. Each node is transformed once per frame and every edge touching it
+reuses that result, so moving a node is a single write: no edge has to be
+found or updated.
+
+    Graph3D graph;
+    int a = graph.addNode(vec4(0, 0, 0), 5.0f);
+    int b = graph.addNode(vec4(50, 0, 0), 5.0f, sf::Color::Red);
+    graph.addEdge(a, b);
+    graph.setPosition(b, vec4(50, 20, 0));
+*/
+
+#include <SFML/Graphics.hpp>
+#include <algorithm>
+#include <array>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "3d_camera.hpp"
+#include "Frustum.hpp"
+#include "Object3D.hpp"
+#include "ProjectedVertices.hpp"
+#include "Shape2D.hpp"
+#include "math4.hpp"
+
+struct Graph3D : Object3D {
+    std::vector<vec4> positions;
+    std::vector<float> radii;
+    std::vector<sf::Color> colors;
+    std::vector<std::array<int, 2>> edges;
+
+    float thickness = 1.0f;  // edge thickness in pixels
+    sf::Color edgeColor = sf::Color(160, 160, 160);
+    int circlePoints = 0;  // 0: chosen from the projected radius
+
+    ProjectedVertices projected;
+    std::vector<int> moved;  // nodes changed since the last prepare()
+    vec4 sum;                // of all positions, for the center
+
+    int addNode(vec4 position, float radius = 1.0f,
+                sf::Color color = sf::Color::White) {
+        positions.push_back(position);
+        radii.push_back(radius);
+        colors.push_back(color);
+        sum += position;
+        projected.invalidate();
+        return static_cast<int>(positions.size()) - 1;
+    }
+
+    void addEdge(int a, int b) { edges.push_back({a, b}); }
+
+    void setPosition(int node, vec4 p) {
+        sum += p - positions[node];
+        positions[node] = p;
+        moved.push_back(node);
+    }
+
+    // Call after writing to positions directly (e.g. from a layout)
+    void markDirty() {
+        sum = vec4();
+        for (vec4& p : positions) sum += p;
+        moved.clear();
+        projected.invalidate();
+    }
+
+    vec4 center() const {
+        if (positions.empty()) return vec4();
+        vec4 s = sum;
+        return s / static_cast<float>(positions.size());
+    }
+
+    void prepare(sf::RenderWindow& window, const Camera& camera) {
+        if (!projected.update(positions, window, camera, thickness)) {
+            // Same view: only the nodes that moved
+            const mat4 inv = camera.cf.inverse_rigid();
+            for (int node : moved) {
+                projected.transformRange(positions.data(), node, node + 1, inv,
+                                         window, camera, thickness);
+            }
+        }
+        moved.clear();
+    }
+
+    // Edges and nodes together, far to near. An edge is drawn just before
+    // the farther of its two nodes, so both nodes cover its ends.
+    void appendTo(Triangles2D& shape, sf::RenderWindow& window,
+                  const Camera& camera, sf::Color tint = sf::Color::White) {
+        const Frustum frustum(window, camera, NEAR, FAR_PLANE, thickness);
+        const sf::Color edge_color = edgeColor * tint;
+        auto& view = projected.view;
+
+        // item >= 0: node, item < 0: edge ~item
+        std::vector<std::pair<float, int>> order;
+        order.reserve(positions.size() + edges.size());
+        for (int n = 0; n < static_cast<int>(positions.size()); n++) {
+            if (view[n].z - radii[n] > NEAR && frustum.intersectsSphere(view[n], radii[n]))
+                order.push_back({view[n].magnitudeSquared(), n});
+        }
+        for (int e = 0; e < static_cast<int>(edges.size()); e++) {
+            float key = std::max(view[edges[e][0]].magnitudeSquared(),
+                                 view[edges[e][1]].magnitudeSquared());
+            order.push_back({key, ~e});
+        }
+        std::sort(order.begin(), order.end(), [](const auto& a, const auto& b) {
+            return a.first != b.first ? a.first > b.first : a.second < b.second;
+        });
+
+        for (const auto& [key, item] : order) {
+            if (item < 0) {
+                const auto& e = edges[~item];
+                sf::Vector2f a_, b_;
+                if (projected.segment(e[0], e[1], frustum, window, camera, a_, b_)) {
+                    appendLine(shape.vertices, a_, b_, thickness, edge_color);
+                }
+                continue;
+            }
+
+            float r = camera.FOV * radii[item] / view[item].z;
+            appendCircle(shape.vertices, projected.screen[item], r,
+                         colors[item] * tint, circlePoints);
+        }
+    }
+
+    float calculateDistance(const Camera& camera) override {
+        return (camera.cf.get_position() - center()).magnitude();
+    }
+
+    std::unique_ptr<Shape2D> computeShape(sf::RenderWindow& window,
+                                          const Camera& camera) override {
+        prepare(window, camera);
+
+        auto shape = std::make_unique<Triangles2D>();
+        appendTo(*shape, window, camera);
+
+        if (shape->vertices.getVertexCount() == 0) return nullptr;
+        return shape;
+    }
+};
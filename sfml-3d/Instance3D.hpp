@@ -0,0 +1,126 @@
+#pragma once
+/*
+Instance3D: one copy of a shared Wireframe3D / Mesh3D model, placed by its own
+transform and drawn in its own color. The model's vertices are stored once no
+matter how many instances there are, and projected vertices live in one
+scratch buffer on the model that each instance reuses while it is drawn.
+
+InstanceSet3D::update computes every model-view matrix in one pass; call it
+each frame after the transforms have changed (e.g. after SceneGraph3D::update).
+*/
+
+#include <SFML/Graphics.hpp>
+#include <algorithm>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "3d_camera.hpp"
+#include "Object3D.hpp"
+#include "ProjectedVertices.hpp"
+#include "Shape2D.hpp"
+#include "Wireframe3D.hpp"
+#include "math4.hpp"
+
+struct InstanceSet3D;
+
+struct Instance3D : Object3D {
+    Wireframe3D* model;
+    mat4 transform;  // model space -> world space
+    sf::Color color;
+
+    // Camera inverse * transform, computed for every instance of a set by
+    // InstanceSet3D::update. Used while the set's camera stamp still matches;
+    // otherwise (or without a set) computeShape works it out itself.
+    mat4 modelview;
+    const InstanceSet3D* set = nullptr;
+
+    Instance3D(Wireframe3D* m, mat4 t = mat4::identity(),
+               sf::Color c = sf::Color::White, const InstanceSet3D* s = nullptr)
+        : model(m), transform(t), color(c), set(s) {}
+
+    vec4 worldCenter() const {
+        mat4 t = transform;
+        return t * model->center;
+    }
+
+    float calculateDistance(const Camera& camera) override {
+        return (camera.cf.get_position() - worldCenter()).magnitude();
+    }
+
+    std::unique_ptr<Shape2D> computeShape(sf::RenderWindow& window,
+                                          const Camera& camera) override;
+};
+
+// Owns the instances of one model and computes all of their model-view
+// matrices in a single pass per frame. Instances point back at the set, so
+// it is neither copied nor moved.
+struct InstanceSet3D {
+    Wireframe3D* model;
+    std::vector<Instance3D> instances;
+
+    // Camera frame the modelviews were last computed for
+    mat4 updated_cf;
+    bool updated = false;
+
+    InstanceSet3D(Wireframe3D* m) : model(m) {}
+
+    InstanceSet3D(const InstanceSet3D&) = delete;
+    InstanceSet3D& operator=(const InstanceSet3D&) = delete;
+
+    Instance3D& add(mat4 transform, sf::Color color = sf::Color::White) {
+        instances.emplace_back(model, transform, color, this);
+        updated = false;
+        return instances.back();
+    }
+
+    // Pointers stay valid as long as no instances are added afterwards
+    void addTo(std::vector<std::pair<int, Object3D*>>& objects, int first_id = 0) {
+        for (std::size_t i = 0; i < instances.size(); i++) {
+            objects.push_back({first_id + static_cast<int>(i), &instances[i]});
+        }
+    }
+
+    bool isCurrent(const Camera& camera) const {
+        return updated && std::equal(updated_cf.m, updated_cf.m + 16, camera.cf.m);
+    }
+
+    // Call once per frame before drawing, after the transforms have changed
+    void update(const Camera& camera) {
+        const mat4 inv = camera.cf.inverse_rigid();
+        updated_cf = camera.cf;
+        updated = true;
+
+        // Same product as mat4::operator*, written out with the camera
+        // matrix held constant so the loop over instances vectorizes
+        for (Instance3D& instance : instances) {
+            const float* b = instance.transform.m;
+            float* r = instance.modelview.m;
+
+            for (int c = 0; c < 4; ++c) {
+                for (int row = 0; row < 4; ++row) {
+                    r[c * 4 + row] = inv.m[0 * 4 + row] * b[c * 4 + 0] +
+                                     inv.m[1 * 4 + row] * b[c * 4 + 1] +
+                                     inv.m[2 * 4 + row] * b[c * 4 + 2] +
+                                     inv.m[3 * 4 + row] * b[c * 4 + 3];
+                }
+            }
+        }
+    }
+};
+
+inline std::unique_ptr<Shape2D> Instance3D::computeShape(sf::RenderWindow& window,
+                                                         const Camera& camera) {
+    if (!set || !set->isCurrent(camera)) {
+        modelview = camera.cf.inverse_rigid() * transform;
+    }
+
+    ProjectedVertices& projected = model->instance_scratch;
+    model->transformVertices(projected, modelview, window, camera);
+
+    auto shape = std::make_unique<Triangles2D>();
+    model->appendTo(*shape, projected, window, camera, color);
+
+    if (shape->vertices.getVertexCount() == 0) return nullptr;
+    return shape;
+}
@@ -0,0 +1,283 @@
+#pragma once
+/*
+Isosurface3D: the surface where a sampled scalar field equals isoValue,
+extracted with surface nets and drawn as a Mesh3D (shared vertices, faces
+and/or wireframe edges).
+
+Every grid cell the surface passes through gets one vertex (the average of
+the points where the field crosses isoValue along the cell's edges), and
+every crossing grid edge connects the four cells around it with a quad.
+
+The volume is split into chunks of chunkSize^3 cells that are extracted in
+parallel; changing samples only re-extracts the chunks around them.
+
+    // f gets positions relative to origin, so (32, 32, 32) is the world origin
+    Isosurface3D iso(64, 64, 64, vec4(-32, -32, -32), 1.0f);
+    iso.sample([](float x, float y, float z) {
+        x -= 32, y -= 32, z -= 32;
+        return x * x + y * y + z * z;
+    });
+    iso.setIsoValue(400.0f);  // sphere of radius 20 around the world origin
+*/
+
+#include <SFML/Graphics.hpp>
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "3d_camera.hpp"
+#include "Object3D.hpp"
+#include "Parallel.hpp"
+#include "Shape2D.hpp"
+#include "Wireframe3D.hpp"
+#include "math4.hpp"
+
+struct Isosurface3D : Object3D {
+    int nx = 0, ny = 0, nz = 0;  // samples per axis
+    vec4 origin;                 // position of sample (0, 0, 0)
+    float spacing = 1.0f;
+    std::vector<float> values;
+    float isoValue = 0.0f;
+
+    int chunkSize = 16;  // cells per chunk along each axis
+    int cx = 0, cy = 0, cz = 0;
+
+    struct Chunk {
+        std::vector<std::array<int, 4>> quads;  // cell indices
+        bool dirty = true;
+    };
+    std::vector<Chunk> chunks;
+
+    // Per cell: surface vertex (valid when the surface crosses the cell)
+    std::vector<vec4> cell_position;
+    std::vector<int> cell_vertex;  // scratch for assembling the mesh
+
+    Mesh3D mesh;
+    bool mesh_dirty = true;
+
+    Isosurface3D() = default;
+    Isosurface3D(int x, int y, int z, vec4 o = vec4(), float s = 1.0f)
+        : nx(x), ny(y), nz(z), origin(o), spacing(s),
+          values(static_cast<std::size_t>(x) * y * z, 0.0f) {
+        cx = std::max(1, (nx - 1 + chunkSize - 1) / chunkSize);
+        cy = std::max(1, (ny - 1 + chunkSize - 1) / chunkSize);
+        cz = std::max(1, (nz - 1 + chunkSize - 1) / chunkSize);
+        chunks.resize(static_cast<std::size_t>(cx) * cy * cz);
+
+        std::size_t cells = static_cast<std::size_t>(std::max(nx - 1, 0)) *
+                            std::max(ny - 1, 0) * std::max(nz - 1, 0);
+        cell_position.resize(cells);
+        cell_vertex.assign(cells, -1);
+    }
+
+    int index(int x, int y, int z) const { return (z * ny + y) * nx + x; }
+    int cellIndex(int x, int y, int z) const {
+        return (z * (ny - 1) + y) * (nx - 1) + x;
+    }
+    int chunkIndex(int i, int j, int k) const { return (k * cy + j) * cx + i; }
+
+    float getValue(int x, int y, int z) const { return values[index(x, y, z)]; }
+
+    void setValue(int x, int y, int z, float v) {
+        values[index(x, y, z)] = v;
+        markDirty(x, y, z, x, y, z);
+    }
+
+    // Evaluates f at the samples in [x0, x1] x [y0, y1] x [z0, z1], given
+    // the sample's position relative to origin
+    void sample(const std::function<float(float, float, float)>& f, int x0,
+                int y0, int z0, int x1, int y1, int z1) {
+        for (int z = z0; z <= z1; z++) {
+            for (int y = y0; y <= y1; y++) {
+                for (int x = x0; x <= x1; x++) {
+                    values[index(x, y, z)] = f(x * spacing, y * spacing, z * spacing);
+                }
+            }
+        }
+        markDirty(x0, y0, z0, x1, y1, z1);
+    }
+
+    void sample(const std::function<float(float, float, float)>& f) {
+        sample(f, 0, 0, 0, nx - 1, ny - 1, nz - 1);
+    }
+
+    void setIsoValue(float v) {
+        isoValue = v;
+        markDirty();
+    }
+
+    // Marks the chunks whose cells touch samples [x0, x1] x ... as changed
+    void markDirty(int x0, int y0, int z0, int x1, int y1, int z1) {
+        auto chunkRange = [&](int lo, int hi, int count, int& c0, int& c1) {
+            c0 = std::max(lo - 1, 0) / chunkSize;
+            c1 = std::min(hi / chunkSize, count - 1);
+        };
+        int i0, i1, j0, j1, k0, k1;
+        chunkRange(x0, x1, cx, i0, i1);
+        chunkRange(y0, y1, cy, j0, j1);
+        chunkRange(z0, z1, cz, k0, k1);
+
+        for (int k = k0; k <= k1; k++) {
+            for (int j = j0; j <= j1; j++) {
+                for (int i = i0; i <= i1; i++) chunks[chunkIndex(i, j, k)].dirty = true;
+            }
+        }
+        mesh_dirty = true;
+    }
+
+    void markDirty() {
+        for (Chunk& chunk : chunks) chunk.dirty = true;
+        mesh_dirty = true;
+    }
+
+    // Surface vertex of cell (x, y, z); false if the surface misses it
+    bool cellVertex(int x, int y, int z, vec4& out) const {
+        float v[8];
+        int inside = 0;
+        for (int c = 0; c < 8; c++) {
+            v[c] = values[index(x + (c & 1), y + (c >> 1 & 1), z + (c >> 2 & 1))] - isoValue;
+            inside += v[c] < 0.0f;
+        }
+        if (inside == 0 || inside == 8) return false;
+
+        static const int cell_edges[12][2] = {{0, 1}, {2, 3}, {4, 5}, {6, 7},
+                                              {0, 2}, {1, 3}, {4, 6}, {5, 7},
+                                              {0, 4}, {1, 5}, {2, 6}, {3, 7}};
+        float sx = 0.0f, sy = 0.0f, sz = 0.0f;
+        int crossings = 0;
+        for (const auto& e : cell_edges) {
+            float a = v[e[0]], b = v[e[1]];
+            if ((a < 0.0f) == (b < 0.0f)) continue;
+
+            float t = a / (a - b);
+            sx += (e[0] & 1) + t * ((e[1] & 1) - (e[0] & 1));
+            sy += (e[0] >> 1 & 1) + t * ((e[1] >> 1 & 1) - (e[0] >> 1 & 1));
+            sz += (e[0] >> 2 & 1) + t * ((e[1] >> 2 & 1) - (e[0] >> 2 & 1));
+            crossings++;
+        }
+
+        out = vec4(origin.x + (x + sx / crossings) * spacing,
+                   origin.y + (y + sy / crossings) * spacing,
+                   origin.z + (z + sz / crossings) * spacing);
+        return true;
+    }
+
+    // Both phases for the cells of one chunk: their vertices, and quads for
+    // the crossing grid edges starting at their corner sample
+    void extractChunk(int ci, int cj, int ck) {
+        Chunk& chunk = chunks[chunkIndex(ci, cj, ck)];
+        chunk.quads.clear();
+
+        const int n[3] = {nx, ny, nz};
+        const int lo[3] = {ci * chunkSize, cj * chunkSize, ck * chunkSize};
+        int hi[3];
+        for (int a = 0; a < 3; a++) hi[a] = std::min(lo[a] + chunkSize, n[a] - 1);
+
+        for (int z = lo[2]; z < hi[2]; z++) {
+            for (int y = lo[1]; y < hi[1]; y++) {
+                for (int x = lo[0]; x < hi[0]; x++) {
+                    cellVertex(x, y, z, cell_position[cellIndex(x, y, z)]);
+                }
+            }
+        }
+
+        for (int z = lo[2]; z < hi[2]; z++) {
+            for (int y = lo[1]; y < hi[1]; y++) {
+                for (int x = lo[0]; x < hi[0]; x++) {
+                    const int p[3] = {x, y, z};
+                    const float here = values[index(x, y, z)] - isoValue;
+
+                    for (int axis = 0; axis < 3; axis++) {
+                        int b = (axis + 1) % 3, c = (axis + 2) % 3;
+                        if (p[b] == 0 || p[c] == 0) continue;
+
+                        int q[3] = {x, y, z};
+                        q[axis]++;
+                        float there = values[index(q[0], q[1], q[2])] - isoValue;
+                        if ((here < 0.0f) == (there < 0.0f)) continue;
+
+                        // The four cells around the edge
+                        int cells[4];
+                        const int offsets[4][2] = {{0, 0}, {1, 0}, {1, 1}, {0, 1}};
+                        for (int k = 0; k < 4; k++) {
+                            int r[3] = {x, y, z};
+                            r[b] -= offsets[k][0];
+                            r[c] -= offsets[k][1];
+                            cells[k] = cellIndex(r[0], r[1], r[2]);
+                        }
+
+                        if (here < 0.0f) {
+                            chunk.quads.push_back({cells[0], cells[1], cells[2], cells[3]});
+                        } else {
+                            chunk.quads.push_back({cells[0], cells[3], cells[2], cells[1]});
+                        }
+                    }
+                }
+            }
+        }
+        chunk.dirty = false;
+    }
+
+    // Re-extracts dirty chunks (in parallel) and rebuilds the mesh
+    void update() {
+        if (!mesh_dirty) return;
+
+        std::vector<int> dirty;
+        for (int k = 0; k < cz; k++) {
+            for (int j = 0; j < cy; j++) {
+                for (int i = 0; i < cx; i++) {
+                    if (chunks[chunkIndex(i, j, k)].dirty) dirty.push_back(chunkIndex(i, j, k));
+                }
+            }
+        }
+
+        parallelFor(0, dirty.size(), [&](std::size_t b, std::size_t e) {
+            for (std::size_t d = b; d < e; d++) {
+                int c = dirty[d];
+                extractChunk(c % cx, c / cx % cy, c / (cx * cy));
+            }
+        }, 1);
+
+        // Chunks can share cells, so vertices are numbered while assembling
+        mesh.vertices.clear();
+        mesh.triangles.clear();
+        std::vector<int> used;
+
+        auto vertexOf = [&](int cell) {
+            if (cell_vertex[cell] < 0) {
+                cell_vertex[cell] = static_cast<int>(mesh.vertices.size());
+                mesh.vertices.push_back(cell_position[cell]);
+                used.push_back(cell);
+            }
+            return cell_vertex[cell];
+        };
+
+        for (const Chunk& chunk : chunks) {
+            for (const auto& quad : chunk.quads) {
+                int v[4];
+                for (int k = 0; k < 4; k++) v[k] = vertexOf(quad[k]);
+                mesh.triangles.push_back({v[0], v[1], v[2]});
+                mesh.triangles.push_back({v[0], v[2], v[3]});
+            }
+        }
+        for (int cell : used) cell_vertex[cell] = -1;
+
+        mesh.buildEdges();
+        mesh.markDirty();
+        mesh_dirty = false;
+    }
+
+    float calculateDistance(const Camera& camera) override {
+        update();
+        return mesh.calculateDistance(camera);
+    }
+
+    std::unique_ptr<Shape2D> computeShape(sf::RenderWindow& window,
+                                          const Camera& camera) override {
+        update();
+        return mesh.computeShape(window, camera);
+    }
+};
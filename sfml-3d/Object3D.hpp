@@ -6,9 +6,12 @@
 #include <optional>
 #include <sfml-util/sfml_util.hpp>
 #include <utility>
+#include <vector>
 
 #include "3d_camera.hpp"
+#include "Frustum.hpp"
 #include "Shape2D.hpp"
+#include "SphereAtlas.hpp"
 #include "math4.hpp"
 
 struct Object3D {
@@ -18,13 +21,14 @@ struct Object3D {
     }
 
     // Distance represents distance to the camera; used for depth sorting
-    float distance;
+    float distance = 0.0f;
     bool distance_updated = false;
 
     virtual float calculateDistance(const Camera& camera) = 0;
     float getDistance(const Camera& camera) {
         if (!distance_updated) {
             distance = calculateDistance(camera);
+            distance_updated = true;
         }
         return distance;
     }
@@ -40,6 +44,18 @@ struct Object3D {
             shape->draw(window, color);
         }
     }
+
+    // Same as draw, but batchable shapes are only added to batcher; call
+    // batcher.flush(window) after the last object
+    void draw(Batcher2D& batcher, sf::RenderWindow& window, const Camera& camera,
+              sf::Color color = sf::Color::White) {
+        if (auto shape = computeShape(window, camera)) {
+            if (!shape->appendTo(batcher, color)) {
+                batcher.flush(window);
+                shape->draw(window, color);
+            }
+        }
+    }
 };
 
 struct Line3D : Object3D {
@@ -50,43 +66,61 @@ struct Line3D : Object3D {
     Line3D(vec4 start, vec4 end, float t = 1.0f)
         : a(start), b(end), thickness(t) {}
 
+    // Exact squared distance from point p to the segment ab
+    static float segmentDistanceSquared(vec4 p, vec4 a, vec4 b) {
+        vec4 ab = b - a;
+        vec4 ap = p - a;
+
+        float len_sq = ab.magnitudeSquared();
+        // Degenerate segment (a == b) falls back to the distance to a
+        float t = len_sq > 0.0f ? ap.dot(ab) / len_sq : 0.0f;
+        t = std::max(0.0f, std::min(1.0f, t));
+
+        return (ap - ab * t).magnitudeSquared();
+    }
+
+    // Squared distance is enough when only lines are being compared
+    float calculateDistanceSquared(const Camera& camera) const {
+        return segmentDistanceSquared(camera.cf.get_position(), a, b);
+    }
+
     float calculateDistance(const Camera& camera) override {
-        const int LINE_RESOLUTION = 3;
-
-        float min_dist = std::numeric_limits<float>::max();
-        for (float i = 0.0f; i <= 1; i += 1.0f / LINE_RESOLUTION) {
-            vec4 intermediate = ((b - a) * i) + a;
-            float new_dist =
-                (camera.cf.get_position() - intermediate).magnitude();
-            if (new_dist < min_dist) {
-                min_dist = new_dist;
-            }
-        }
-        return min_dist;
+        return std::sqrt(calculateDistanceSquared(camera));
     }
 
-    std::unique_ptr<Shape2D> computeShape(sf::RenderWindow& window,
-                                          const Camera& camera) override {
-        mat4 camera_inverse = camera.cf.inverse_rigid();
-        vec4 a_t = camera_inverse * a;
-        vec4 b_t = camera_inverse * b;
+    // Clipped view-space endpoints filled in by LineBatch::clip for every
+    // line at once. computeShape only uses them while the view, endpoints and
+    // thickness are still the ones they were computed for.
+    vec4 clipped_a, clipped_b;
+    bool clip_visible = false;
+    ViewKey clip_key;
+    vec4 clip_source_a, clip_source_b;
+    float clip_thickness = 0.0f;
+
+    bool clipIsCurrent(const sf::RenderWindow& window, const Camera& camera) const {
+        return clip_key.matches(window, camera) && clip_source_a == a &&
+               clip_source_b == b && clip_thickness == thickness;
+    }
 
-        if (a_t.z <= 0 && b_t.z <= 0) return nullptr;
+    // Projection into a 2D shape held by value. Collection calls this
+    // directly; computeShape wraps it.
+    using Shape = Line2D;
 
-        if (a_t.z <= 0) {
-            float t = (NEAR - a_t.z) / (b_t.z - a_t.z);
+    std::optional<Line2D> project(sf::RenderWindow& window, const Camera& camera) {
+        vec4 a_t, b_t;
 
-            a_t.x = a_t.x + t * (b_t.x - a_t.x);
-            a_t.y = a_t.y + t * (b_t.y - a_t.y);
-            a_t.z = NEAR;
-        }
+        if (clipIsCurrent(window, camera)) {
+            if (!clip_visible) return std::nullopt;
 
-        if (b_t.z <= 0) {
-            float t = (NEAR - a_t.z) / (b_t.z - a_t.z);
+            a_t = clipped_a;
+            b_t = clipped_b;
+        } else {
+            mat4 camera_inverse = camera.cf.inverse_rigid();
+            a_t = camera_inverse * a;
+            b_t = camera_inverse * b;
 
-            b_t.x = a_t.x + t * (b_t.x - a_t.x);
-            b_t.y = a_t.y + t * (b_t.y - a_t.y);
-            b_t.z = NEAR;
+            Frustum frustum(window, camera, NEAR, FAR_PLANE, thickness);
+            if (!frustum.clipSegment(a_t, b_t)) return std::nullopt;
         }
 
         sf::Vector2f a_ =
@@ -94,7 +128,150 @@ struct Line3D : Object3D {
         sf::Vector2f b_ =
             normalize_point(window, convert_3d_to_2d(b_t, camera));
 
-        return std::make_unique<Line2D>(a_, b_, thickness);
+        return Line2D(a_, b_, thickness);
+    }
+
+    std::unique_ptr<Shape2D> computeShape(sf::RenderWindow& window,
+                                          const Camera& camera) override {
+        if (auto shape = project(window, camera)) return std::make_unique<Line2D>(*shape);
+        return nullptr;
+    }
+};
+
+// Line endpoints laid out as structure-of-arrays so the distance (or clipping)
+// of every line in a collection can be done in one branch-free, vectorizable
+// loop
+struct LineBatch {
+    std::vector<Line3D*> lines;
+    std::vector<float> ax, ay, az, bx, by, bz;
+    std::vector<float> thickness;
+    std::vector<float> result;  // squared distances
+    std::vector<float> range;   // clipped [t0, t1] of each line, interleaved
+
+    void clear() { lines.clear(); }
+
+    void add(Line3D* line) { lines.push_back(line); }
+
+    void gather() {
+        std::size_t n = lines.size();
+        ax.resize(n); ay.resize(n); az.resize(n);
+        bx.resize(n); by.resize(n); bz.resize(n);
+        thickness.resize(n);
+        result.resize(n);
+        range.resize(2 * n);
+
+        for (std::size_t i = 0; i < n; i++) {
+            ax[i] = lines[i]->a.x; ay[i] = lines[i]->a.y; az[i] = lines[i]->a.z;
+            bx[i] = lines[i]->b.x; by[i] = lines[i]->b.y; bz[i] = lines[i]->b.z;
+            thickness[i] = lines[i]->thickness;
+        }
+    }
+
+    // Fills in the cached distance of every line (same value as
+    // Line3D::calculateDistance, just computed for all lines at once)
+    void computeDistances(const Camera& camera) {
+        gather();
+
+        const vec4 p = camera.cf.get_position();
+        const std::size_t n = lines.size();
+        const float* ax_ = ax.data(); const float* ay_ = ay.data();
+        const float* az_ = az.data(); const float* bx_ = bx.data();
+        const float* by_ = by.data(); const float* bz_ = bz.data();
+        float* out = result.data();
+
+        for (std::size_t i = 0; i < n; i++) {
+            float abx = bx_[i] - ax_[i], aby = by_[i] - ay_[i],
+                  abz = bz_[i] - az_[i];
+            float apx = p.x - ax_[i], apy = p.y - ay_[i], apz = p.z - az_[i];
+
+            float len_sq = abx * abx + aby * aby + abz * abz;
+            float t = (apx * abx + apy * aby + apz * abz) /
+                      std::max(len_sq, std::numeric_limits<float>::min());
+            t = std::max(0.0f, std::min(1.0f, t));
+
+            float dx = apx - abx * t, dy = apy - aby * t, dz = apz - abz * t;
+            out[i] = dx * dx + dy * dy + dz * dz;
+        }
+
+        // sqrt is kept out of the loop above so it stays vectorizable even
+        // when math errno is enabled
+        for (std::size_t i = 0; i < n; i++) {
+            lines[i]->distance = std::sqrt(out[i]);
+            lines[i]->distance_updated = true;
+        }
+    }
+
+    // Clips every line against the full view frustum and leaves the result in
+    // the line's clipped_a / clipped_b for computeShape. Like Line3D's own
+    // clipping, the sides are widened by each line's thickness.
+    void clip(const sf::RenderWindow& window, const Camera& camera) {
+        gather();
+
+        const std::size_t n = lines.size();
+        const Frustum frustum(window, camera, NEAR, FAR_PLANE);
+        const float half_width = window.getSize().x / 2.0f;
+        const float half_height = window.getSize().y / 2.0f;
+        const float FOV = camera.FOV;
+        const mat4 inv = camera.cf.inverse_rigid();
+        const float m0 = inv.m[0], m1 = inv.m[1], m2 = inv.m[2];
+        const float m4 = inv.m[4], m5 = inv.m[5], m6 = inv.m[6];
+        const float m8 = inv.m[8], m9 = inv.m[9], m10 = inv.m[10];
+        const float m12 = inv.m[12], m13 = inv.m[13], m14 = inv.m[14];
+        const float near = frustum.near, far = frustum.far;
+
+        // The world-space arrays are overwritten with view-space coordinates
+        auto toView = [&](float* xs, float* ys, float* zs) {
+            for (std::size_t i = 0; i < n; i++) {
+                float x = xs[i], y = ys[i], z = zs[i];
+                xs[i] = m0 * x + m4 * y + m8 * z + m12;
+                ys[i] = m1 * x + m5 * y + m9 * z + m13;
+                zs[i] = m2 * x + m6 * y + m10 * z + m14;
+            }
+        };
+        toView(ax.data(), ay.data(), az.data());
+        toView(bx.data(), by.data(), bz.data());
+
+        const float* ax_ = ax.data(); const float* ay_ = ay.data();
+        const float* az_ = az.data(); const float* bx_ = bx.data();
+        const float* by_ = by.data(); const float* bz_ = bz.data();
+        const float* thickness_ = thickness.data();
+        float* range_ = range.data();
+
+        // A single output array keeps the number of runtime aliasing checks
+        // low enough for the compiler to still vectorize this loop
+        for (std::size_t i = 0; i < n; i++) {
+            float x0 = ax_[i], y0 = ay_[i], z0 = az_[i];
+            float x1 = bx_[i], y1 = by_[i], z1 = bz_[i];
+            float kx = (half_width + thickness_[i]) / FOV;
+            float ky = (half_height + thickness_[i]) / FOV;
+
+            float lo = 0.0f, hi = 1.0f;
+            Frustum::clipAgainstPlaneBatch(z0 - near, z1 - near, lo, hi);
+            Frustum::clipAgainstPlaneBatch(far - z0, far - z1, lo, hi);
+            Frustum::clipAgainstPlaneBatch(x0 + kx * z0, x1 + kx * z1, lo, hi);
+            Frustum::clipAgainstPlaneBatch(kx * z0 - x0, kx * z1 - x1, lo, hi);
+            Frustum::clipAgainstPlaneBatch(y0 + ky * z0, y1 + ky * z1, lo, hi);
+            Frustum::clipAgainstPlaneBatch(ky * z0 - y0, ky * z1 - y1, lo, hi);
+
+            range_[2 * i] = lo;
+            range_[2 * i + 1] = hi;
+        }
+
+        for (std::size_t i = 0; i < n; i++) {
+            Line3D* line = lines[i];
+            vec4 a_t(ax_[i], ay_[i], az_[i]);
+            vec4 d(bx_[i] - ax_[i], by_[i] - ay_[i], bz_[i] - az_[i]);
+
+            float lo = range_[2 * i], hi = range_[2 * i + 1];
+
+            line->clip_visible = lo <= hi;
+            line->clipped_a = a_t + d * lo;
+            line->clipped_b = a_t + d * hi;
+            line->clip_key.set(window, camera);
+            line->clip_source_a = line->a;
+            line->clip_source_b = line->b;
+            line->clip_thickness = line->thickness;
+        }
     }
 };
 
@@ -110,19 +287,34 @@ struct Sphere3D : Object3D {
         return center_dist - radius;
     }
 
-    std::unique_ptr<Shape2D> computeShape(sf::RenderWindow& window,
-                                          const Camera& camera) override {
+    // Projection into a 2D shape held by value (a flat circle while
+    // SPHERE_SPRITES is unset). Collection calls this directly; computeShape
+    // wraps it.
+    using Shape = SphereSprite2D;
+
+    std::optional<SphereSprite2D> project(sf::RenderWindow& window,
+                                          const Camera& camera) {
         mat4 camera_inverse = camera.cf.inverse_rigid();
         vec4 view_pos = camera_inverse * position;
 
-        if (view_pos.z <= NEAR) return nullptr;
+        if (view_pos.z <= NEAR) return std::nullopt;
 
         float projected_radius = camera.FOV * radius / view_pos.z;
+        if (projected_radius < MIN_PROJECTED_RADIUS) return std::nullopt;
 
         sf::Vector2f screen_pos =
             normalize_point(window, convert_3d_to_2d(view_pos, camera));
 
-        return std::make_unique<Circle2D>(screen_pos, projected_radius);
+        return SphereSprite2D(screen_pos, projected_radius, SPHERE_SPRITES);
+    }
+
+    std::unique_ptr<Shape2D> computeShape(sf::RenderWindow& window,
+                                          const Camera& camera) override {
+        auto shape = project(window, camera);
+        if (!shape) return nullptr;
+
+        if (shape->atlas) return std::make_unique<SphereSprite2D>(*shape);
+        return std::make_unique<Circle2D>(shape->center, shape->radius);
     }
 };
 
@@ -0,0 +1,146 @@
+#pragma once
+/*
+Slab allocation for Object3Ds: objects are constructed in large contiguous
+chunks (one set of chunks per type) and released all at once, instead of a
+separate new/delete per object.
+
+    ObjectPool3D pool;
+    Sphere3D* s = pool.create<Sphere3D>(vec4(0, 0, 0), 10.0f);
+    ...
+    pool.clear();  // destroys every object, keeps the memory for reuse
+*/
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Chunked storage for objects of a single type. Objects never move once
+// created, so the returned pointers stay valid until clear()/release().
+template <typename T>
+struct SlabPool {
+    struct Slot {
+        alignas(T) unsigned char bytes[sizeof(T)];
+    };
+
+    std::size_t chunkSize;
+    std::vector<std::unique_ptr<Slot[]>> chunks;
+    std::size_t count = 0;  // objects currently alive
+
+    SlabPool(std::size_t chunk_size = 4096) : chunkSize(chunk_size) {}
+
+    SlabPool(const SlabPool&) = delete;
+    SlabPool& operator=(const SlabPool&) = delete;
+
+    ~SlabPool() { clear(); }
+
+    T* at(std::size_t i) {
+        Slot& slot = chunks[i / chunkSize][i % chunkSize];
+        return std::launder(reinterpret_cast<T*>(slot.bytes));
+    }
+
+    void addChunk() {
+        // new Slot[] rather than make_unique, which would zero the memory
+        chunks.push_back(std::unique_ptr<Slot[]>(new Slot[chunkSize]));
+    }
+
+    template <typename... Args>
+    T* create(Args&&... args) {
+        if (count == chunks.size() * chunkSize) {
+            addChunk();
+        }
+
+        Slot& slot = chunks[count / chunkSize][count % chunkSize];
+        T* object = new (slot.bytes) T(std::forward<Args>(args)...);
+        count++;
+        return object;
+    }
+
+    // Makes sure n objects fit without allocating during create()
+    void reserve(std::size_t n) {
+        while (chunks.size() * chunkSize < n) {
+            addChunk();
+        }
+    }
+
+    // Destroys all objects but keeps the chunks, so rebuilding a scene of the
+    // same size allocates nothing
+    void clear() {
+        if constexpr (!std::is_trivially_destructible_v<T>) {
+            for (std::size_t i = 0; i < count; i++) {
+                at(i)->~T();
+            }
+        }
+        count = 0;
+    }
+
+    // Destroys all objects and frees the chunks
+    void release() {
+        clear();
+        chunks.clear();
+    }
+};
+
+// One SlabPool per object type, so objects of the same type end up next to
+// each other in memory
+struct ObjectPool3D {
+    struct PoolBase {
+        virtual ~PoolBase() = default;
+        virtual void clear() = 0;
+        virtual void release() = 0;
+    };
+
+    template <typename T>
+    struct Pool : PoolBase {
+        SlabPool<T> slab;
+
+        Pool(std::size_t chunk_size) : slab(chunk_size) {}
+        void clear() override { slab.clear(); }
+        void release() override { slab.release(); }
+    };
+
+    std::size_t chunkSize;
+    std::vector<std::unique_ptr<PoolBase>> pools;  // indexed by typeIndex<T>()
+
+    ObjectPool3D(std::size_t chunk_size = 4096) : chunkSize(chunk_size) {}
+
+    // Small sequential id per type, used instead of a map lookup per create()
+    static std::size_t nextTypeIndex() {
+        static std::size_t next = 0;
+        return next++;
+    }
+
+    template <typename T>
+    static std::size_t typeIndex() {
+        static const std::size_t index = nextTypeIndex();
+        return index;
+    }
+
+    template <typename T>
+    SlabPool<T>& pool() {
+        std::size_t index = typeIndex<T>();
+        if (index >= pools.size()) pools.resize(index + 1);
+        if (!pools[index]) pools[index] = std::make_unique<Pool<T>>(chunkSize);
+
+        return static_cast<Pool<T>*>(pools[index].get())->slab;
+    }
+
+    template <typename T, typename... Args>
+    T* create(Args&&... args) {
+        return pool<T>().create(std::forward<Args>(args)...);
+    }
+
+    void clear() {
+        for (auto& p : pools) {
+            if (p) p->clear();
+        }
+    }
+
+    void release() {
+        for (auto& p : pools) {
+            if (p) p->release();
+        }
+    }
+};
@@ -0,0 +1,44 @@
+#pragma once
+/*
+Building blocks of the point octrees (PointCloud3D, ForceLayout3D): every
+node covers a contiguous range of an index array, which is reordered by
+octant when the node is split.
+*/
+
+#include <algorithm>
+#include <array>
+#include <vector>
+
+#include "math4.hpp"
+
+// Octant of v around center: bit 0 set for x >= center.x, bit 1 for y, bit 2 for z
+int octantOf(const vec4& v, const vec4& center) {
+    return (v.x >= center.x ? 1 : 0) | (v.y >= center.y ? 2 : 0) |
+           (v.z >= center.z ? 4 : 0);
+}
+
+// Center of child octant o of a cube with the given center and half edge
+vec4 octantCenter(const vec4& center, float half, int o) {
+    float h = half / 2.0f;
+    return vec4(center.x + (o & 1 ? h : -h), center.y + (o & 2 ? h : -h),
+                center.z + (o & 4 ? h : -h));
+}
+
+// Counting sort of order[begin, end) by the octant of points[order[i]]
+// (scratch must be as long as order). Octant o ends up in
+// [begin + start[o], begin + start[o + 1]) of the returned start.
+std::array<int, 9> partitionOctants(const std::vector<vec4>& points, const vec4& center,
+                                    int begin, int end, std::vector<int>& order,
+                                    std::vector<int>& scratch) {
+    std::array<int, 9> start{};
+    for (int i = begin; i < end; i++) start[octantOf(points[order[i]], center) + 1]++;
+    for (int o = 0; o < 8; o++) start[o + 1] += start[o];
+
+    std::array<int, 8> fill = {};
+    for (int i = begin; i < end; i++) {
+        int o = octantOf(points[order[i]], center);
+        scratch[begin + start[o] + fill[o]++] = order[i];
+    }
+    std::copy(scratch.begin() + begin, scratch.begin() + end, order.begin() + begin);
+    return start;
+}
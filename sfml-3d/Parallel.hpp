@@ -0,0 +1,150 @@
+#pragma once
+/*
+parallelFor: runs fn(chunk_begin, chunk_end) over contiguous chunks of
+[begin, end) on a pool of worker threads. The pool is started on first use
+and reused by every later call; the calling thread takes a chunk too and
+returns once all chunks are done. Ranges shorter than two chunks, and calls
+made from inside a chunk, run on the calling thread.
+Link with -pthread (Threads::Threads in CMake).
+*/
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+unsigned int workerCount() {
+    unsigned int n = std::thread::hardware_concurrency();
+    return n == 0 ? 1 : n;
+}
+
+// Set on pool threads, and on the caller while it waits for a run
+thread_local bool inside_parallel_for = false;
+
+// Threads that sleep until run() hands them tasks 0..count-1 to share with
+// the caller. One run at a time; the task is called through a plain function
+// pointer so nothing is allocated per call.
+struct WorkerPool {
+    std::vector<std::thread> workers;
+    std::mutex run_mutex;  // serializes callers
+    std::mutex mutex;
+    std::condition_variable wake, idle;
+    bool stopping = false;
+    std::uint64_t generation = 0;
+    unsigned int active = 0;  // workers inside drain()
+
+    const void* context = nullptr;
+    void (*call)(const void*, std::size_t) = nullptr;
+    std::size_t task_count = 0;
+    std::atomic<std::size_t> next{0};
+    std::size_t remaining = 0;
+
+    explicit WorkerPool(unsigned int threads) {
+        workers.reserve(threads);
+        for (unsigned int i = 0; i < threads; i++) {
+            workers.emplace_back([this] { work(); });
+        }
+    }
+
+    ~WorkerPool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (std::thread& t : workers) t.join();
+    }
+
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+
+    std::size_t size() const { return workers.size(); }
+
+    template <typename Task>
+    void run(std::size_t count, const Task& task) {
+        std::lock_guard<std::mutex> serial(run_mutex);
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            idle.wait(lock, [&] { return active == 0; });
+            context = &task;
+            call = [](const void* c, std::size_t i) {
+                (*static_cast<const Task*>(c))(i);
+            };
+            task_count = count;
+            next.store(0);
+            remaining = count;
+            generation++;
+        }
+        wake.notify_all();
+
+        inside_parallel_for = true;
+        drain();
+        inside_parallel_for = false;
+
+        std::unique_lock<std::mutex> lock(mutex);
+        idle.wait(lock, [&] { return remaining == 0; });
+    }
+
+    void work() {
+        inside_parallel_for = true;
+        std::uint64_t seen = 0;
+        for (;;) {
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                wake.wait(lock, [&] { return stopping || generation != seen; });
+                if (stopping) return;
+                seen = generation;
+                active++;
+            }
+            drain();
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                active--;
+            }
+            idle.notify_all();
+        }
+    }
+
+    // Takes tasks until none are left
+    void drain() {
+        for (;;) {
+            std::size_t i = next.fetch_add(1);
+            if (i >= task_count) return;
+            call(context, i);
+
+            std::lock_guard<std::mutex> lock(mutex);
+            if (--remaining == 0) idle.notify_all();
+        }
+    }
+};
+
+// The caller works too, so the pool has one thread fewer than the hardware
+WorkerPool& workerPool() {
+    static WorkerPool pool(workerCount() - 1);
+    return pool;
+}
+
+template <typename Fn>
+void parallelFor(std::size_t begin, std::size_t end, Fn fn,
+                 std::size_t minChunk = 16384) {
+    if (end <= begin) return;
+    const std::size_t n = end - begin;
+
+    std::size_t workers = std::min<std::size_t>(
+        workerCount(), (n + minChunk - 1) / std::max<std::size_t>(minChunk, 1));
+    if (workers <= 1 || inside_parallel_for) {
+        fn(begin, end);
+        return;
+    }
+
+    const std::size_t chunk = (n + workers - 1) / workers;
+    workerPool().run(workers, [&](std::size_t w) {
+        std::size_t b = begin + w * chunk;
+        std::size_t e = std::min(end, b + chunk);
+        if (b < e) fn(b, e);
+    });
+}
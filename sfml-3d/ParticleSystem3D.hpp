@@ -0,0 +1,175 @@
+#pragma once
+/*
+ParticleSystem3D: many short-lived points stored as structure-of-arrays, so
+integration and projection are plain loops over float arrays that the
+compiler vectorizes (and parallelFor spreads over threads for large counts).
+Dead particles are removed by swapping in the last one, so the live particles
+always occupy [0, count).
+*/
+
+#include <SFML/Graphics.hpp>
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+#include "3d_camera.hpp"
+#include "Object3D.hpp"
+#include "Parallel.hpp"
+#include "Shape2D.hpp"
+#include "math4.hpp"
+
+struct ParticleSystem3D : Object3D {
+    // All arrays are sized to the capacity once; spawn fails when full
+    std::vector<float> px, py, pz;  // position
+    std::vector<float> vx, vy, vz;  // velocity
+    std::vector<float> life;        // seconds left
+    std::vector<sf::Color> color;
+    std::size_t count = 0;
+
+    vec4 gravity;         // acceleration applied to every particle
+    float drag = 0.0f;    // fraction of velocity lost per second
+    float size = 1.0f;    // world-space size of a particle
+    float minPixelSize = 1.0f;
+    vec4 origin;          // depth key when sorted in a collection
+
+    // Below this many particles everything runs on the calling thread
+    std::size_t parallelThreshold = 65536;
+
+    // x, y and pixel size of every particle (size 0 when culled), filled by
+    // computeShape
+    std::vector<float> projected;
+
+    ParticleSystem3D(std::size_t capacity = 65536)
+        : px(capacity), py(capacity), pz(capacity),
+          vx(capacity), vy(capacity), vz(capacity),
+          life(capacity), color(capacity), projected(capacity * 3) {}
+
+    std::size_t capacity() const { return px.size(); }
+
+    bool spawn(vec4 position, vec4 velocity, float lifetime,
+               sf::Color c = sf::Color::White) {
+        if (count == capacity()) return false;
+
+        std::size_t i = count++;
+        px[i] = position.x;
+        py[i] = position.y;
+        pz[i] = position.z;
+        vx[i] = velocity.x;
+        vy[i] = velocity.y;
+        vz[i] = velocity.z;
+        life[i] = lifetime;
+        color[i] = c;
+        return true;
+    }
+
+    // Removes particle i by moving the last particle into its slot
+    void kill(std::size_t i) {
+        std::size_t last = --count;
+        px[i] = px[last];
+        py[i] = py[last];
+        pz[i] = pz[last];
+        vx[i] = vx[last];
+        vy[i] = vy[last];
+        vz[i] = vz[last];
+        life[i] = life[last];
+        color[i] = color[last];
+    }
+
+    void clear() { count = 0; }
+
+    // One axis of the integration; only two arrays, so it vectorizes
+    static void integrate(float* p, float* v, std::size_t n, float a,
+                          float damping, float dt) {
+        for (std::size_t i = 0; i < n; i++) {
+            v[i] = v[i] * damping + a * dt;
+            p[i] += v[i] * dt;
+        }
+    }
+
+    // Advances every particle by dt seconds and removes the expired ones
+    void update(float dt) {
+        const float damping = std::max(0.0f, 1.0f - drag * dt);
+
+        parallelFor(0, count, [&](std::size_t b, std::size_t e) {
+            integrate(&px[b], &vx[b], e - b, gravity.x, damping, dt);
+            integrate(&py[b], &vy[b], e - b, gravity.y, damping, dt);
+            integrate(&pz[b], &vz[b], e - b, gravity.z, damping, dt);
+            for (std::size_t i = b; i < e; i++) life[i] -= dt;
+        }, parallelThreshold);
+
+        // Going backwards, the particle swapped in has already been checked
+        for (std::size_t i = count; i-- > 0;) {
+            if (life[i] <= 0.0f) kill(i);
+        }
+    }
+
+    float calculateDistance(const Camera& camera) override {
+        return (camera.cf.get_position() - origin).magnitude();
+    }
+
+    // Projects particles [b, e) into projected; branch-free so it vectorizes
+    void project(std::size_t b, std::size_t e, const mat4& inv, float FOV,
+                 float width, float height) {
+        const float* m = inv.m;
+        float* out = projected.data();
+
+        for (std::size_t i = b; i < e; i++) {
+            float x = m[0] * px[i] + m[4] * py[i] + m[8] * pz[i] + m[12];
+            float y = m[1] * px[i] + m[5] * py[i] + m[9] * pz[i] + m[13];
+            float z = m[2] * px[i] + m[6] * py[i] + m[10] * pz[i] + m[14];
+
+            float inv_z = 1.0f / std::max(z, NEAR);
+            float s = std::max(FOV * size * inv_z, minPixelSize);
+            float sx = FOV * x * inv_z + width / 2.0f;
+            float sy = height / 2.0f - FOV * y * inv_z;
+
+            bool visible = (z >= NEAR) & (z <= FAR_PLANE) & (sx >= -s) &
+                           (sx <= width + s) & (sy >= -s) & (sy <= height + s);
+
+            out[3 * i] = sx;
+            out[3 * i + 1] = sy;
+            out[3 * i + 2] = visible ? s : 0.0f;
+        }
+    }
+
+    std::unique_ptr<Shape2D> computeShape(sf::RenderWindow& window,
+                                          const Camera& camera) override {
+        const mat4 inv = camera.cf.inverse_rigid();
+        const float width = static_cast<float>(window.getSize().x);
+        const float height = static_cast<float>(window.getSize().y);
+
+        parallelFor(0, count, [&](std::size_t b, std::size_t e) {
+            project(b, e, inv, camera.FOV, width, height);
+        }, parallelThreshold);
+
+        std::size_t visible = 0;
+        for (std::size_t i = 0; i < count; i++) {
+            visible += projected[3 * i + 2] > 0.0f;
+        }
+
+        // Sized once and written in place instead of growing with append
+        auto shape = std::make_unique<Triangles2D>();
+        sf::VertexArray& vertices = shape->vertices;
+        vertices.resize(visible * 6);
+
+        std::size_t k = 0;
+        for (std::size_t i = 0; i < count; i++) {
+            float h = projected[3 * i + 2] / 2.0f;
+            if (h <= 0.0f) continue;
+
+            float x = projected[3 * i], y = projected[3 * i + 1];
+            sf::Vector2f p0(x - h, y - h), p1(x + h, y - h);
+            sf::Vector2f p2(x + h, y + h), p3(x - h, y + h);
+
+            vertices[k++] = {p0, color[i]};
+            vertices[k++] = {p1, color[i]};
+            vertices[k++] = {p2, color[i]};
+            vertices[k++] = {p0, color[i]};
+            vertices[k++] = {p2, color[i]};
+            vertices[k++] = {p3, color[i]};
+        }
+
+        if (shape->vertices.getVertexCount() == 0) return nullptr;
+        return shape;
+    }
+};
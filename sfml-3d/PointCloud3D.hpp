@@ -0,0 +1,189 @@
+#pragma once
+/*
+PointCloud3D: millions of points as one object, backed by an octree. Each
+frame only as much detail as is visible on screen is drawn: far-away nodes are
+drawn from a small sample of their points, and the total number of points
+drawn is capped by pointBudget.
+*/
+
+#include <SFML/Graphics.hpp>
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+#include <memory>
+#include <queue>
+#include <utility>
+#include <vector>
+
+#include "3d_camera.hpp"
+#include "Frustum.hpp"
+#include "Object3D.hpp"
+#include "OctreePartition.hpp"
+#include "Shape2D.hpp"
+#include "math4.hpp"
+
+struct PointCloud3D : Object3D {
+    // build() reorders points (and colors) so every octree node covers a
+    // contiguous range of them
+    std::vector<vec4> points;
+    std::vector<sf::Color> colors;  // optional, one per point
+
+    float pointSize = 2.0f;      // in pixels
+    float maxError = 1.5f;       // allowed gap between drawn points, in pixels
+    std::size_t pointBudget = 2'000'000;
+    int leafSize = 256;
+    int samplesPerNode = 256;    // most points drawn from an inner node
+
+    struct Node {
+        vec4 center;
+        float half;  // half the edge length of the node's cube
+        int begin, end;
+        std::array<int, 8> children;
+    };
+    std::vector<Node> nodes;
+
+    PointCloud3D() = default;
+    PointCloud3D(std::vector<vec4> p, std::vector<sf::Color> c = {})
+        : points(std::move(p)), colors(std::move(c)) {
+        build();
+    }
+
+    // Call after changing points
+    void build() {
+        nodes.clear();
+        if (points.empty()) return;
+
+        vec4 lo(std::numeric_limits<float>::max(), std::numeric_limits<float>::max(),
+                std::numeric_limits<float>::max());
+        vec4 hi(std::numeric_limits<float>::lowest(), std::numeric_limits<float>::lowest(),
+                std::numeric_limits<float>::lowest());
+        for (const vec4& p : points) {
+            lo = vec4(std::min(lo.x, p.x), std::min(lo.y, p.y), std::min(lo.z, p.z));
+            hi = vec4(std::max(hi.x, p.x), std::max(hi.y, p.y), std::max(hi.z, p.z));
+        }
+        vec4 center = (lo + hi) * 0.5f;
+        float half = std::max({hi.x - lo.x, hi.y - lo.y, hi.z - lo.z}) * 0.5f;
+
+        std::vector<int> order(points.size());
+        for (std::size_t i = 0; i < order.size(); i++) order[i] = static_cast<int>(i);
+        std::vector<int> scratch(points.size());
+
+        buildNode(center, half, 0, static_cast<int>(points.size()), 0, order, scratch);
+
+        std::vector<vec4> sorted_points(points.size());
+        for (std::size_t i = 0; i < order.size(); i++) sorted_points[i] = points[order[i]];
+        points = std::move(sorted_points);
+
+        if (colors.size() == order.size()) {
+            std::vector<sf::Color> sorted_colors(colors.size());
+            for (std::size_t i = 0; i < order.size(); i++) sorted_colors[i] = colors[order[i]];
+            colors = std::move(sorted_colors);
+        }
+    }
+
+    int buildNode(vec4 center, float half, int begin, int end, int depth,
+                  std::vector<int>& order, std::vector<int>& scratch) {
+        int index = static_cast<int>(nodes.size());
+        Node node{center, half, begin, end, {}};
+        node.children.fill(-1);
+        nodes.push_back(node);
+
+        if (end - begin <= leafSize || depth >= 20) return index;
+
+        std::array<int, 9> start = partitionOctants(points, center, begin, end, order, scratch);
+
+        for (int o = 0; o < 8; o++) {
+            int b = begin + start[o], e = begin + start[o + 1];
+            if (b == e) continue;
+
+            int child = buildNode(octantCenter(center, half, o), half / 2.0f, b, e,
+                                  depth + 1, order, scratch);
+            nodes[index].children[o] = child;
+        }
+        return index;
+    }
+
+    float calculateDistance(const Camera& camera) override {
+        if (nodes.empty()) return 0.0f;
+        return (camera.cf.get_position() - nodes[0].center).magnitude();
+    }
+
+    std::unique_ptr<Shape2D> computeShape(sf::RenderWindow& window,
+                                          const Camera& camera) override {
+        if (nodes.empty()) return nullptr;
+
+        const mat4 inv = camera.cf.inverse_rigid();
+        const Frustum frustum(window, camera, NEAR, FAR_PLANE, pointSize);
+        const float sqrt3 = 1.7320508f;
+
+        auto shape = std::make_unique<Triangles2D>();
+        std::size_t emitted = 0;
+
+        auto emit = [&](int begin, int end, int stride) {
+            mat4 m = inv;
+            for (int i = begin; i < end; i += stride) {
+                vec4 v = m * points[i];
+                if (!frustum.containsPoint(v)) continue;
+
+                sf::Color color = colors.empty() ? sf::Color::White : colors[i];
+                appendPoint(shape->vertices,
+                            normalize_point(window, convert_3d_to_2d(v, camera)),
+                            pointSize, color);
+                emitted++;
+            }
+        };
+
+        // Nodes are refined largest-on-screen first, so when the budget runs
+        // out it is the least visible detail that gets left out
+        using Item = std::pair<float, int>;  // projected size, node
+        std::priority_queue<Item> queue;
+
+        auto push = [&](int index) {
+            const Node& node = nodes[index];
+            mat4 m = inv;
+            vec4 c = m * node.center;
+            float r = node.half * sqrt3;
+            if (!frustum.intersectsSphere(c, r)) return;
+
+            // Nodes reaching behind the camera are always refined
+            float z = c.z - r > NEAR ? c.z : NEAR;
+            queue.push({camera.FOV * 2.0f * node.half / z, index});
+        };
+        push(0);
+
+        while (!queue.empty()) {
+            auto [projected, index] = queue.top();
+            queue.pop();
+            const Node& node = nodes[index];
+            int count = node.end - node.begin;
+
+            bool leaf = node.children[0] < 0 && node.children[1] < 0 &&
+                        node.children[2] < 0 && node.children[3] < 0 &&
+                        node.children[4] < 0 && node.children[5] < 0 &&
+                        node.children[6] < 0 && node.children[7] < 0;
+
+            // Scanned points lie on surfaces, so n points spread over the
+            // node are about projected / sqrt(n) pixels apart: this is how
+            // many it takes to keep the gaps below maxError
+            float ratio = projected / maxError;
+            float needed = std::max(1.0f, ratio * ratio);
+            bool over_budget = emitted + std::min<float>(needed, count) > pointBudget;
+
+            if (leaf || needed <= samplesPerNode || over_budget) {
+                int draw = static_cast<int>(std::min<float>(needed, count));
+                if (over_budget) draw = std::min(draw, samplesPerNode);
+
+                emit(node.begin, node.end, std::max(1, count / std::max(draw, 1)));
+                if (emitted >= pointBudget) break;
+            } else {
+                for (int child : node.children) {
+                    if (child >= 0) push(child);
+                }
+            }
+        }
+
+        if (shape->vertices.getVertexCount() == 0) return nullptr;
+        return shape;
+    }
+};
@@ -0,0 +1,308 @@
+#pragma once
+/*
+Polyline3D: a long connected path (trajectories, plots, outlines). Each vertex
+is transformed once per view, the path is clipped against the frustum into
+visible runs, and every run is drawn as one mitered strip.
+
+For depth sorting the path is split into chunks of chunkSize segments, each a
+separate object in the collection, instead of one object per segment.
+
+With simplifyTolerance > 0, vertices that change the drawn path by less than
+that many pixels are skipped (Douglas–Peucker on the projected path), so the
+cost of dense paths follows their detail on screen.
+*/
+
+#include <SFML/Graphics.hpp>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "3d_camera.hpp"
+#include "Frustum.hpp"
+#include "Object3D.hpp"
+#include "ProjectedVertices.hpp"
+#include "Shape2D.hpp"
+#include "math4.hpp"
+
+struct Polyline3D;
+
+// Segments [begin, end) of a Polyline3D as one object in the collection
+struct PolylineChunk3D : Object3D {
+    Polyline3D* parent;
+    int begin, end;
+
+    PolylineChunk3D(Polyline3D* p, int b, int e) : parent(p), begin(b), end(e) {}
+
+    float calculateDistance(const Camera& camera) override;
+
+    std::unique_ptr<Shape2D> computeShape(sf::RenderWindow& window,
+                                          const Camera& camera) override;
+};
+
+struct Polyline3D : Object3D {
+    std::vector<vec4> vertices;
+    float thickness = 1.0f;
+
+    // Segments per chunk when added to a collection; 0 adds the whole path
+    // as a single object
+    int chunkSize = 64;
+
+    // Bounding sphere, used as the depth key when sorted as one object
+    vec4 center;
+    float radius = 0.0f;
+
+    // Screen-space simplification; 0 draws every vertex. The simplified path
+    // is kept until the camera moves by more than resimplifyFraction of its
+    // distance to the path, turns by more than resimplifyFraction radians,
+    // or the FOV / window / tolerance changes.
+    float simplifyTolerance = 0.0f;  // in pixels
+    float resimplifyFraction = 0.05f;
+
+    // Per-view cache filled by prepare()
+    ProjectedVertices projected;
+
+    std::vector<int> kept;  // vertices drawn when simplifying, ascending
+    std::vector<char> keep;
+    ViewKey simplify_key;  // view and tolerance kept was computed for
+    float simplify_tolerance = 0.0f;
+
+    std::vector<PolylineChunk3D> chunks;
+    std::vector<sf::Vector2f> run;  // scratch for the current visible run
+
+    Polyline3D() = default;
+    Polyline3D(std::vector<vec4> v, float t = 1.0f)
+        : vertices(std::move(v)), thickness(t) {
+        updateBounds();
+    }
+
+    // Chunks and collections point back at this polyline, so it never moves:
+    // keep it where it was constructed (a member, a local, an ObjectPool3D,
+    // a std::unique_ptr...)
+    Polyline3D(const Polyline3D&) = delete;
+    Polyline3D& operator=(const Polyline3D&) = delete;
+    Polyline3D(Polyline3D&&) = delete;
+    Polyline3D& operator=(Polyline3D&&) = delete;
+
+    // Joins runs of consecutive lines where each starts at the end of the
+    // previous one into polylines (e.g. trajectories stored as Line3D chains).
+    // Each polyline is heap allocated so it keeps its address (its chunks
+    // point back at it) when the returned vector grows or moves.
+    static std::vector<std::unique_ptr<Polyline3D>> fromLines(
+        const std::vector<Line3D*>& lines) {
+        std::vector<std::unique_ptr<Polyline3D>> result;
+        for (std::size_t i = 0; i < lines.size(); i++) {
+            Line3D* line = lines[i];
+            if (i == 0 || !(lines[i - 1]->b == line->a)) {
+                result.push_back(std::make_unique<Polyline3D>());
+                result.back()->thickness = line->thickness;
+                result.back()->vertices.push_back(line->a);
+            }
+            result.back()->vertices.push_back(line->b);
+        }
+        for (auto& polyline : result) polyline->updateBounds();
+        return result;
+    }
+
+    int segmentCount() const {
+        return std::max(0, static_cast<int>(vertices.size()) - 1);
+    }
+
+    // Call after changing vertices
+    void markDirty() {
+        updateBounds();
+        projected.invalidate();
+        simplify_key.invalidate();
+    }
+
+    void updateBounds() {
+        center = vec4();
+        radius = 0.0f;
+        if (vertices.empty()) return;
+
+        for (vec4& v : vertices) center += v;
+        center /= static_cast<float>(vertices.size());
+        for (vec4& v : vertices) {
+            radius = std::max(radius, (v - center).magnitude());
+        }
+    }
+
+    // Adds this path to a collection (e.g. collection.c), split into chunks
+    // of chunkSize segments. Must be called again if the vertex count changes.
+    // The entries point into this object, which must outlive them.
+    void addTo(std::vector<std::pair<int, Object3D*>>& objects, int id) {
+        if (chunkSize <= 0) {
+            objects.push_back({id, this});
+            return;
+        }
+
+        chunks.clear();
+        for (int b = 0; b < segmentCount(); b += chunkSize) {
+            chunks.emplace_back(this, b, std::min(b + chunkSize, segmentCount()));
+        }
+        for (auto& chunk : chunks) objects.push_back({id, &chunk});
+    }
+
+    void prepare(sf::RenderWindow& window, const Camera& camera) {
+        projected.update(vertices, window, camera, thickness);
+        if (simplifyTolerance > 0.0f && needsSimplify(window, camera)) {
+            simplify(window, camera);
+        }
+    }
+
+    bool needsSimplify(sf::RenderWindow& window, const Camera& camera) const {
+        if (!simplify_key.sameProjection(window, camera) || kept.empty() ||
+            kept.back() != static_cast<int>(vertices.size()) - 1 ||
+            simplify_tolerance != simplifyTolerance)
+            return true;
+        if (simplify_key.turnSince(camera) > resimplifyFraction) return true;
+
+        vec4 eye = camera.cf.get_position();
+        float distance = std::max((eye - center).magnitude() - radius, NEAR);
+        return (eye - simplify_key.cf.get_position()).magnitude() >
+               resimplifyFraction * distance;
+    }
+
+    // Douglas–Peucker over the projected vertices (after projected.update).
+    // Ends of chunks and vertices near the camera plane are always kept, so
+    // chunks and clipping work on the simplified path unchanged.
+    void simplify(sf::RenderWindow& window, const Camera& camera) {
+        const int n = static_cast<int>(vertices.size());
+        const auto& in_front = projected.in_front;
+        const auto& screen = projected.screen;
+
+        keep.assign(n, 0);
+        if (n > 0) keep[0] = keep[n - 1] = 1;
+        for (int i = 0; i < n; i++) {
+            if (chunkSize > 0 && i % chunkSize == 0) keep[i] = 1;
+            if (!in_front[i]) {
+                keep[i] = 1;
+                if (i > 0) keep[i - 1] = 1;
+                if (i + 1 < n) keep[i + 1] = 1;
+            }
+        }
+
+        // Between two kept vertices every vertex is in front of the camera
+        std::vector<std::pair<int, int>> stack;
+        for (int i = 0; i < n - 1;) {
+            int j = i + 1;
+            while (!keep[j]) j++;
+            stack.push_back({i, j});
+
+            while (!stack.empty()) {
+                auto [a, b] = stack.back();
+                stack.pop_back();
+                if (b - a < 2) continue;
+
+                int worst = -1;
+                float worst_distance = simplifyTolerance;
+                for (int k = a + 1; k < b; k++) {
+                    float d = distanceToLineSegment(screen[k], screen[a], screen[b]);
+                    if (d > worst_distance) {
+                        worst_distance = d;
+                        worst = k;
+                    }
+                }
+                if (worst < 0) continue;
+
+                keep[worst] = 1;
+                stack.push_back({a, worst});
+                stack.push_back({worst, b});
+            }
+            i = j;
+        }
+
+        kept.clear();
+        for (int i = 0; i < n; i++) {
+            if (keep[i]) kept.push_back(i);
+        }
+
+        simplify_key.set(window, camera);
+        simplify_tolerance = simplifyTolerance;
+    }
+
+    // Appends segments [begin, end) (after prepare). Consecutive visible
+    // segments are joined into one strip; a run ends wherever the path
+    // leaves the frustum.
+    void appendRange(Triangles2D& shape, sf::RenderWindow& window,
+                     const Camera& camera, int begin, int end,
+                     sf::Color color = sf::Color::White) {
+        Frustum frustum(window, camera, NEAR, FAR_PLANE, thickness);
+
+        auto flush = [&]() {
+            appendPolyline(shape.vertices, run.data(), run.size(), thickness, color);
+            run.clear();
+        };
+
+        auto segment = [&](int i, int j) {
+            sf::Vector2f a_, b_;
+            bool clipped_a, clipped_b;
+            if (!projected.segment(i, j, frustum, window, camera, a_, b_,
+                                   &clipped_a, &clipped_b)) {
+                flush();
+                return;
+            }
+
+            if (run.empty() || clipped_a) {
+                flush();
+                run.push_back(a_);
+            }
+            run.push_back(b_);
+            if (clipped_b) flush();
+        };
+
+        run.clear();
+        if (simplifyTolerance > 0.0f && simplify_key.valid) {
+            // Kept vertices strictly inside the range, from begin to end
+            int prev = begin;
+            auto it = std::upper_bound(kept.begin(), kept.end(), begin);
+            for (; it != kept.end() && *it < end; ++it) {
+                segment(prev, *it);
+                prev = *it;
+            }
+            if (prev < end) segment(prev, end);
+        } else {
+            for (int s = begin; s < end; s++) segment(s, s + 1);
+        }
+        flush();
+    }
+
+    float calculateDistance(const Camera& camera) override {
+        return (camera.cf.get_position() - center).magnitude();
+    }
+
+    std::unique_ptr<Shape2D> computeShape(sf::RenderWindow& window,
+                                          const Camera& camera) override {
+        prepare(window, camera);
+
+        auto shape = std::make_unique<Triangles2D>();
+        appendRange(*shape, window, camera, 0, segmentCount());
+
+        if (shape->vertices.getVertexCount() == 0) return nullptr;
+        return shape;
+    }
+};
+
+// Distance to the closest segment of the chunk
+inline float PolylineChunk3D::calculateDistance(const Camera& camera) {
+    const vec4 eye = camera.cf.get_position();
+    float best = std::numeric_limits<float>::max();
+    for (int s = begin; s < end; s++) {
+        best = std::min(best, Line3D::segmentDistanceSquared(
+                                  eye, parent->vertices[s], parent->vertices[s + 1]));
+    }
+    return std::sqrt(best);
+}
+
+inline std::unique_ptr<Shape2D> PolylineChunk3D::computeShape(
+    sf::RenderWindow& window, const Camera& camera) {
+    parent->prepare(window, camera);
+
+    auto shape = std::make_unique<Triangles2D>();
+    parent->appendRange(*shape, window, camera, begin, end);
+
+    if (shape->vertices.getVertexCount() == 0) return nullptr;
+    return shape;
+}
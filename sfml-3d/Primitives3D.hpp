@@ -0,0 +1,247 @@
+#pragma once
+/*
+Compile-time wireframe primitives. Every generator is constexpr and returns
+std::array vertex and edge tables, so the shapes cost nothing at startup and
+loops over them have fixed trip counts. Shapes are unit sized and centered on
+the origin (y up); place and scale them with an Instance3D or SceneGraph3D
+node.
+
+    constexpr auto SPHERE = icosphereWireframe<2>();
+    Wireframe3D sphere(SPHERE.vertices, SPHERE.edges);
+*/
+
+#include <array>
+#include <cstddef>
+
+#include "Wireframe3D.hpp"
+#include "math4.hpp"
+
+template <std::size_t V, std::size_t E>
+struct WireframeTable {
+    std::array<vec4, V> vertices{};
+    std::array<std::array<int, 2>, E> edges{};
+
+    Wireframe3D wireframe(float thickness = 1.0f) const {
+        return Wireframe3D(vertices, edges, thickness);
+    }
+};
+
+// Icosahedron subdivided N times, with its vertices on the unit sphere.
+// Faces and their edges are kept so every level can be built from the
+// previous one in linear time (and for use as a Mesh3D).
+template <int N>
+struct Icosphere {
+    static constexpr std::size_t F = std::size_t(20) << (2 * N);
+    static constexpr std::size_t E = std::size_t(30) << (2 * N);
+    static constexpr std::size_t V = E - F + 2;  // Euler: V - E + F = 2
+
+    std::array<vec4, V> vertices{};
+    std::array<std::array<int, 2>, E> edges{};
+    std::array<std::array<int, 3>, F> faces{};
+    std::array<std::array<int, 3>, F> face_edges{};  // edge k joins corners k, k + 1
+};
+
+constexpr vec4 unitVector(double x, double y, double z) {
+    double length = constSqrt(x * x + y * y + z * z);
+    return vec4(static_cast<float>(x / length), static_cast<float>(y / length),
+                static_cast<float>(z / length));
+}
+
+template <int N>
+constexpr Icosphere<N> icosphere() {
+    Icosphere<N> out{};
+
+    if constexpr (N == 0) {
+        const double t = (1.0 + constSqrt(5.0)) / 2.0;
+        const double corners[12][3] = {{-1, t, 0}, {1, t, 0}, {-1, -t, 0}, {1, -t, 0},
+                                       {0, -1, t}, {0, 1, t}, {0, -1, -t}, {0, 1, -t},
+                                       {t, 0, -1}, {t, 0, 1}, {-t, 0, -1}, {-t, 0, 1}};
+        const int faces[20][3] = {{0, 11, 5}, {0, 5, 1},  {0, 1, 7},   {0, 7, 10},
+                                  {0, 10, 11}, {1, 5, 9}, {5, 11, 4},  {11, 10, 2},
+                                  {10, 7, 6}, {7, 1, 8},  {3, 9, 4},   {3, 4, 2},
+                                  {3, 2, 6},  {3, 6, 8},  {3, 8, 9},   {4, 9, 5},
+                                  {2, 4, 11}, {6, 2, 10}, {8, 6, 7},   {9, 8, 1}};
+
+        for (int i = 0; i < 12; i++) {
+            out.vertices[i] = unitVector(corners[i][0], corners[i][1], corners[i][2]);
+        }
+
+        // 30 edges, found by search
+        int edge_count = 0;
+        for (int f = 0; f < 20; f++) {
+            for (int k = 0; k < 3; k++) {
+                int a = faces[f][k], b = faces[f][(k + 1) % 3];
+                int found = -1;
+                for (int e = 0; e < edge_count; e++) {
+                    if ((out.edges[e][0] == a && out.edges[e][1] == b) ||
+                        (out.edges[e][0] == b && out.edges[e][1] == a))
+                        found = e;
+                }
+                if (found < 0) {
+                    out.edges[edge_count] = {a, b};
+                    found = edge_count++;
+                }
+                out.faces[f][k] = a;
+                out.face_edges[f][k] = found;
+            }
+        }
+    } else {
+        const Icosphere<N - 1> in = icosphere<N - 1>();
+        const int v0 = static_cast<int>(Icosphere<N - 1>::V);
+        const int e0 = static_cast<int>(Icosphere<N - 1>::E);
+
+        // Old vertices, then one midpoint per old edge
+        for (int i = 0; i < v0; i++) out.vertices[i] = in.vertices[i];
+        for (int e = 0; e < e0; e++) {
+            const vec4& a = in.vertices[in.edges[e][0]];
+            const vec4& b = in.vertices[in.edges[e][1]];
+            out.vertices[v0 + e] = unitVector(double(a.x) + b.x, double(a.y) + b.y,
+                                              double(a.z) + b.z);
+        }
+
+        // Every old edge splits in two: 2e starts at its first vertex
+        for (int e = 0; e < e0; e++) {
+            out.edges[2 * e] = {in.edges[e][0], v0 + e};
+            out.edges[2 * e + 1] = {v0 + e, in.edges[e][1]};
+        }
+        auto half = [&](int e, int vertex) {
+            return in.edges[e][0] == vertex ? 2 * e : 2 * e + 1;
+        };
+
+        // Every old face splits in four, adding three inner edges
+        for (int f = 0; f < static_cast<int>(Icosphere<N - 1>::F); f++) {
+            const int a = in.faces[f][0], b = in.faces[f][1], c = in.faces[f][2];
+            const int ab = in.face_edges[f][0], bc = in.face_edges[f][1],
+                      ca = in.face_edges[f][2];
+            const int m_ab = v0 + ab, m_bc = v0 + bc, m_ca = v0 + ca;
+
+            const int inner = 2 * e0 + 3 * f;
+            out.edges[inner] = {m_ab, m_bc};
+            out.edges[inner + 1] = {m_bc, m_ca};
+            out.edges[inner + 2] = {m_ca, m_ab};
+
+            out.faces[4 * f] = {a, m_ab, m_ca};
+            out.face_edges[4 * f] = {half(ab, a), inner + 2, half(ca, a)};
+            out.faces[4 * f + 1] = {b, m_bc, m_ab};
+            out.face_edges[4 * f + 1] = {half(bc, b), inner, half(ab, b)};
+            out.faces[4 * f + 2] = {c, m_ca, m_bc};
+            out.face_edges[4 * f + 2] = {half(ca, c), inner + 1, half(bc, c)};
+            out.faces[4 * f + 3] = {m_ab, m_bc, m_ca};
+            out.face_edges[4 * f + 3] = {inner, inner + 1, inner + 2};
+        }
+    }
+    return out;
+}
+
+// Unit sphere, 10 * 4^N + 2 vertices
+template <int N>
+constexpr auto icosphereWireframe() {
+    const Icosphere<N> sphere = icosphere<N>();
+    WireframeTable<Icosphere<N>::V, Icosphere<N>::E> out{};
+    out.vertices = sphere.vertices;
+    out.edges = sphere.edges;
+    return out;
+}
+
+// Radius 1, from y = -1 to y = 1: two rings and Segments vertical edges
+template <int Segments>
+constexpr auto cylinderWireframe() {
+    WireframeTable<2 * Segments, 3 * Segments> out{};
+    for (int i = 0; i < Segments; i++) {
+        double angle = 2.0 * CONST_PI * i / Segments;
+        float x = static_cast<float>(constCos(angle));
+        float z = static_cast<float>(constSin(angle));
+        out.vertices[i] = vec4(x, -1.0f, z);
+        out.vertices[Segments + i] = vec4(x, 1.0f, z);
+
+        int next = (i + 1) % Segments;
+        out.edges[i] = {i, next};
+        out.edges[Segments + i] = {Segments + i, Segments + next};
+        out.edges[2 * Segments + i] = {i, Segments + i};
+    }
+    return out;
+}
+
+// Base of radius 1 at y = -1, apex at y = 1
+template <int Segments>
+constexpr auto coneWireframe() {
+    WireframeTable<Segments + 1, 2 * Segments> out{};
+    out.vertices[Segments] = vec4(0.0f, 1.0f, 0.0f);
+    for (int i = 0; i < Segments; i++) {
+        double angle = 2.0 * CONST_PI * i / Segments;
+        out.vertices[i] = vec4(static_cast<float>(constCos(angle)), -1.0f,
+                               static_cast<float>(constSin(angle)));
+        out.edges[i] = {i, (i + 1) % Segments};
+        out.edges[Segments + i] = {i, Segments};
+    }
+    return out;
+}
+
+// Square from -1 to 1 in the y = 0 plane, split into Columns x Rows cells
+template <int Columns, int Rows>
+constexpr auto gridWireframe() {
+    WireframeTable<2 * (Columns + 1) + 2 * (Rows + 1), (Columns + 1) + (Rows + 1)> out{};
+    int v = 0, e = 0;
+    for (int i = 0; i <= Columns; i++) {
+        float x = -1.0f + 2.0f * i / Columns;
+        out.vertices[v] = vec4(x, 0.0f, -1.0f);
+        out.vertices[v + 1] = vec4(x, 0.0f, 1.0f);
+        out.edges[e++] = {v, v + 1};
+        v += 2;
+    }
+    for (int j = 0; j <= Rows; j++) {
+        float z = -1.0f + 2.0f * j / Rows;
+        out.vertices[v] = vec4(-1.0f, 0.0f, z);
+        out.vertices[v + 1] = vec4(1.0f, 0.0f, z);
+        out.edges[e++] = {v, v + 1};
+        v += 2;
+    }
+    return out;
+}
+
+// X, Y and Z axes of length 1 from the origin, each with a small arrow head
+constexpr auto axisGizmoWireframe(float head = 0.1f) {
+    WireframeTable<10, 9> out{};
+    out.vertices[0] = vec4(0.0f, 0.0f, 0.0f);
+    for (int axis = 0; axis < 3; axis++) {
+        // Tip, then two barbs bent back towards the next axis and the one after
+        float tip[3] = {0.0f, 0.0f, 0.0f};
+        tip[axis] = 1.0f;
+        float barb_a[3] = {tip[0], tip[1], tip[2]}, barb_b[3] = {tip[0], tip[1], tip[2]};
+        barb_a[axis] -= head, barb_b[axis] -= head;
+        barb_a[(axis + 1) % 3] += head / 2.0f;
+        barb_b[(axis + 2) % 3] += head / 2.0f;
+
+        const int v = 1 + 3 * axis;
+        out.vertices[v] = vec4(tip[0], tip[1], tip[2]);
+        out.vertices[v + 1] = vec4(barb_a[0], barb_a[1], barb_a[2]);
+        out.vertices[v + 2] = vec4(barb_b[0], barb_b[1], barb_b[2]);
+        out.edges[3 * axis] = {0, v};
+        out.edges[3 * axis + 1] = {v, v + 1};
+        out.edges[3 * axis + 2] = {v, v + 2};
+    }
+    return out;
+}
+
+// Ring of radius 1 around the y axis with a tube of the given radius:
+// Major rings around the tube and Minor lines along it
+template <int Major, int Minor>
+constexpr auto torusWireframe(float tube = 0.25f) {
+    WireframeTable<Major * Minor, 2 * Major * Minor> out{};
+    for (int i = 0; i < Major; i++) {
+        double u = 2.0 * CONST_PI * i / Major;
+        double cu = constCos(u), su = constSin(u);
+        for (int j = 0; j < Minor; j++) {
+            double w = 2.0 * CONST_PI * j / Minor;
+            double r = 1.0 + tube * constCos(w);
+
+            const int v = i * Minor + j;
+            out.vertices[v] = vec4(static_cast<float>(r * cu),
+                                   static_cast<float>(tube * constSin(w)),
+                                   static_cast<float>(r * su));
+            out.edges[2 * v] = {v, i * Minor + (j + 1) % Minor};
+            out.edges[2 * v + 1] = {v, ((i + 1) % Major) * Minor + j};
+        }
+    }
+    return out;
+}
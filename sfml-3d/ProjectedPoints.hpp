@@ -0,0 +1,81 @@
+#pragma once
+/*
+Screen-space copies of a point set drawn as camera-facing quads or circles
+(SpriteSet3D, SphereView3D). Every point gets four floats: depth (0 when
+culled), x, y and pixel size. project() fills ranges of them (from any
+thread), then gather() lists the points that survived, farthest first.
+*/
+
+#include <SFML/Graphics.hpp>
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+#include "3d_camera.hpp"
+#include "Object3D.hpp"
+#include "math4.hpp"
+
+struct ProjectedPoints {
+    std::vector<float> values;  // depth, x, y, pixel size per point
+    std::vector<int> visible;   // filled by gather()
+
+    // Camera inverse and screen size, computed once per pass
+    struct View {
+        mat4 inv;
+        float FOV, width, height;
+
+        View(const sf::RenderWindow& window, const Camera& camera)
+            : inv(camera.cf.inverse_rigid()), FOV(camera.FOV),
+              width(static_cast<float>(window.getSize().x)),
+              height(static_cast<float>(window.getSize().y)) {}
+    };
+
+    void resize(std::size_t n) { values.resize(4 * n); }
+    std::size_t size() const { return values.size() / 4; }
+
+    float depth(std::size_t i) const { return values[4 * i]; }
+    sf::Vector2f position(std::size_t i) const {
+        return {values[4 * i + 1], values[4 * i + 2]};
+    }
+    float pixelSize(std::size_t i) const { return values[4 * i + 3]; }
+
+    // Point i at p with the given world size. Culled when behind the camera,
+    // past FAR_PLANE, smaller than min_size pixels or off screen by more than
+    // half(pixel size), its on-screen half extent.
+    template <typename Half>
+    void project(std::size_t i, float px, float py, float pz, float size,
+                 float min_size, const View& view, Half half) {
+        const float* m = view.inv.m;
+        float x = m[0] * px + m[4] * py + m[8] * pz + m[12];
+        float y = m[1] * px + m[5] * py + m[9] * pz + m[13];
+        float z = m[2] * px + m[6] * py + m[10] * pz + m[14];
+
+        float inv_z = 1.0f / std::max(z, NEAR);
+        float s = view.FOV * size * inv_z;
+        float sx = view.FOV * x * inv_z + view.width / 2.0f;
+        float sy = view.height / 2.0f - view.FOV * y * inv_z;
+
+        sf::Vector2f h = half(s);
+        bool shown = (z > NEAR) & (z <= FAR_PLANE) & (s >= min_size) & (sx >= -h.x) &
+                     (sx <= view.width + h.x) & (sy >= -h.y) & (sy <= view.height + h.y);
+
+        float* out = values.data() + 4 * i;
+        out[0] = shown ? z : 0.0f;
+        out[1] = sx;
+        out[2] = sy;
+        out[3] = s;
+    }
+
+    // Lists the points that were not culled, farthest first if sorted
+    void gather(bool sort_by_depth = true) {
+        const std::size_t n = size();
+        visible.clear();
+        for (std::size_t i = 0; i < n; i++) {
+            if (values[4 * i] > 0.0f) visible.push_back(static_cast<int>(i));
+        }
+        if (sort_by_depth) {
+            std::sort(visible.begin(), visible.end(),
+                      [&](int a, int b) { return values[4 * a] > values[4 * b]; });
+        }
+    }
+};
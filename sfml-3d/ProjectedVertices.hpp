@@ -0,0 +1,103 @@
+#pragma once
+/*
+View-space and screen-space copies of a vertex list, shared by the indexed
+primitives (Wireframe3D, Polyline3D, ...) so every vertex is transformed and
+projected once per view no matter how many edges use it
+*/
+
+#include <SFML/Graphics.hpp>
+#include <vector>
+
+#include "3d_camera.hpp"
+#include "Frustum.hpp"
+#include "Object3D.hpp"
+#include "math4.hpp"
+
+struct ProjectedVertices {
+    std::vector<vec4> view;            // view-space vertices
+    std::vector<sf::Vector2f> screen;  // projection (valid when in_front)
+    std::vector<char> in_front;        // in front of the near plane
+    std::vector<char> inside;          // inside the whole frustum
+    ViewKey key;
+
+    static sf::Vector2f project(sf::RenderWindow& window, const Camera& camera,
+                                vec4 view_point) {
+        return normalize_point(window,
+                               Object3D::convert_3d_to_2d(view_point, camera));
+    }
+
+    // Recomputes everything if the view changed since the last call.
+    // Returns false when the cached values were still valid.
+    bool update(const std::vector<vec4>& vertices, sf::RenderWindow& window,
+                const Camera& camera, float margin = 0.0f) {
+        if (key.matches(window, camera) && view.size() == vertices.size())
+            return false;
+        key.set(window, camera);
+
+        transform(vertices.data(), vertices.size(), camera.cf.inverse_rigid(),
+                  window, camera, margin);
+        return true;
+    }
+
+    // Call after the vertices changed
+    void invalidate() { key.invalidate(); }
+
+    void resize(std::size_t n) {
+        view.resize(n);
+        screen.resize(n);
+        in_front.resize(n);
+        inside.resize(n);
+    }
+
+    // Transforms with any model-view matrix (also used by instances, whose
+    // result does not belong to the cached view)
+    void transform(const vec4* vertices, std::size_t n, mat4 modelview,
+                   sf::RenderWindow& window, const Camera& camera,
+                   float margin = 0.0f) {
+        resize(n);
+        transformRange(vertices, 0, n, modelview, window, camera, margin);
+    }
+
+    // Only [begin, end) is recomputed; the arrays must already be sized
+    void transformRange(const vec4* vertices, std::size_t begin, std::size_t end,
+                        mat4 modelview, sf::RenderWindow& window,
+                        const Camera& camera, float margin = 0.0f) {
+        Frustum frustum(window, camera, NEAR, FAR_PLANE, margin);
+
+        for (std::size_t i = begin; i < end; i++) {
+            view[i] = modelview * vertices[i];
+        }
+        for (std::size_t i = begin; i < end; i++) {
+            in_front[i] = view[i].z >= NEAR;
+            inside[i] = frustum.containsPoint(view[i]);
+            if (in_front[i]) screen[i] = project(window, camera, view[i]);
+        }
+    }
+
+    // Screen-space endpoints of the segment between vertices i and j.
+    // Segments fully inside the frustum reuse the projected vertices; others
+    // are clipped first (clipped_a / clipped_b report which ends moved).
+    bool segment(int i, int j, const Frustum& frustum, sf::RenderWindow& window,
+                 const Camera& camera, sf::Vector2f& a_, sf::Vector2f& b_,
+                 bool* clipped_a = nullptr, bool* clipped_b = nullptr) const {
+        if (clipped_a) *clipped_a = false;
+        if (clipped_b) *clipped_b = false;
+
+        if (inside[i] && inside[j]) {
+            a_ = screen[i];
+            b_ = screen[j];
+            return true;
+        }
+
+        vec4 a = view[i], b = view[j];
+        if (!frustum.clipSegment(a, b)) return false;
+
+        bool a_moved = !(a == view[i]), b_moved = !(b == view[j]);
+        if (clipped_a) *clipped_a = a_moved;
+        if (clipped_b) *clipped_b = b_moved;
+
+        a_ = in_front[i] && !a_moved ? screen[i] : project(window, camera, a);
+        b_ = in_front[j] && !b_moved ? screen[j] : project(window, camera, b);
+        return true;
+    }
+};
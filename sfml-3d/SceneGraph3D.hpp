@@ -0,0 +1,153 @@
+#pragma once
+/*
+Hierarchical transforms: each node has a local matrix relative to its parent,
+and world matrices are only recomputed for subtrees whose transforms changed.
+
+    SceneGraph3D graph;
+    int arm = graph.addNode(-1, mat4::translation(0, 50, 0));
+    int hand = graph.addNode(arm, mat4::translation(0, 0, 40));
+    graph.attach(hand, instance.transform);   // Instance3D follows the hand
+    graph.attachPoint(hand, sphere.position);  // so does a Sphere3D
+    ...
+    graph.setLocal(arm, mat4::rotation_y(t));  // moves the hand too
+    graph.update();                            // once per frame
+*/
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+#include "math4.hpp"
+
+struct SceneGraph3D {
+    // Nodes are stored in depth-first order: a parent always comes before its
+    // children and every subtree occupies a contiguous range of slots, so the
+    // update is a forward pass over flat arrays.
+    // Handles returned by addNode stay the same when slots move.
+    std::vector<int> parent;        // slot of the parent, -1 for roots
+    std::vector<int> subtree_size;  // number of slots in the subtree (itself included)
+    std::vector<mat4> local;
+    std::vector<mat4> world;
+    std::vector<char> dirty;        // local changed since the last update
+    std::vector<char> changed;      // world was recomputed in the last update
+
+    std::vector<int> slot_of_handle;
+    bool any_dirty = false;
+
+    struct Attachment {
+        int handle;
+        mat4* target;
+    };
+    struct PointAttachment {
+        int handle;
+        vec4* target;
+        vec4 local_point;
+    };
+    std::vector<Attachment> attachments;
+    std::vector<PointAttachment> point_attachments;
+
+    std::size_t size() const { return parent.size(); }
+
+    // Adds a node under parent_handle (-1 for a new root) and returns its handle
+    int addNode(int parent_handle = -1, mat4 local_transform = mat4::identity()) {
+        int slot;
+        int parent_slot = -1;
+
+        if (parent_handle < 0) {
+            slot = static_cast<int>(size());
+        } else {
+            parent_slot = slot_of_handle[parent_handle];
+            slot = parent_slot + subtree_size[parent_slot];
+        }
+
+        // Everything from slot onwards moves up by one
+        for (int& p : parent) {
+            if (p >= slot) p++;
+        }
+        for (int& s : slot_of_handle) {
+            if (s >= slot) s++;
+        }
+        for (int p = parent_slot; p >= 0; p = parent[p]) {
+            subtree_size[p]++;
+        }
+
+        int handle = static_cast<int>(slot_of_handle.size());
+        slot_of_handle.push_back(slot);
+
+        parent.insert(parent.begin() + slot, parent_slot);
+        subtree_size.insert(subtree_size.begin() + slot, 1);
+        local.insert(local.begin() + slot, local_transform);
+        world.insert(world.begin() + slot, local_transform);
+        dirty.insert(dirty.begin() + slot, 1);
+        changed.insert(changed.begin() + slot, 0);
+
+        any_dirty = true;
+        return handle;
+    }
+
+    void setLocal(int handle, mat4 m) {
+        int slot = slot_of_handle[handle];
+        local[slot] = m;
+        dirty[slot] = 1;
+        any_dirty = true;
+    }
+
+    const mat4& getLocal(int handle) const { return local[slot_of_handle[handle]]; }
+
+    // World matrices are evaluated lazily: reading one brings the graph up to date
+    const mat4& getWorld(int handle) {
+        update();
+        return world[slot_of_handle[handle]];
+    }
+
+    // Writes the node's world matrix into target whenever it changes
+    void attach(int handle, mat4& target) {
+        attachments.push_back({handle, &target});
+        any_dirty = true;
+        dirty[slot_of_handle[handle]] = 1;
+    }
+
+    // Writes world * local_point into target whenever the node moves
+    void attachPoint(int handle, vec4& target, vec4 local_point = vec4()) {
+        point_attachments.push_back({handle, &target, local_point});
+        any_dirty = true;
+        dirty[slot_of_handle[handle]] = 1;
+    }
+
+    void update() {
+        if (!any_dirty) return;
+
+        const int n = static_cast<int>(size());
+        std::fill(changed.begin(), changed.end(), 0);
+
+        int i = 0;
+        while (i < n) {
+            if (!dirty[i]) {
+                i++;
+                continue;
+            }
+
+            // Recompute the whole subtree under the first dirty node found;
+            // anything dirty inside it is covered as well
+            int end = i + subtree_size[i];
+            for (int j = i; j < end; j++) {
+                int p = parent[j];
+                world[j] = p >= 0 ? world[p] * local[j] : local[j];
+                changed[j] = 1;
+                dirty[j] = 0;
+            }
+            i = end;
+        }
+
+        for (const Attachment& a : attachments) {
+            int slot = slot_of_handle[a.handle];
+            if (changed[slot]) *a.target = world[slot];
+        }
+        for (const PointAttachment& a : point_attachments) {
+            int slot = slot_of_handle[a.handle];
+            if (changed[slot]) *a.target = world[slot] * a.local_point;
+        }
+
+        any_dirty = false;
+    }
+};
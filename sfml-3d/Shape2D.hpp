@@ -6,11 +6,17 @@
 #include <sfml-util/sfml_util.hpp>
 #include <utility>
 
+#include "Batcher2D.hpp"
+
 struct Shape2D {
     virtual ~Shape2D() = default;
 
     virtual void draw(sf::RenderWindow& window, sf::Color color) = 0;
 
+    // Adds the shape to a batch instead of drawing it right away. Shapes
+    // that can't be batched return false and are drawn with draw().
+    virtual bool appendTo(Batcher2D& /*batcher*/, sf::Color /*color*/) { return false; }
+
     virtual bool computeCollisionWithPoint(sf::Vector2f point) = 0;
 };
 
@@ -26,6 +32,11 @@ struct Line2D : Shape2D {
         drawLine(window, a, b, thickness, color);
     }
 
+    bool appendTo(Batcher2D& batcher, sf::Color color) override {
+        appendLine(batcher.get(), a, b, thickness, color);
+        return true;
+    }
+
     bool computeCollisionWithPoint(sf::Vector2f point) override {
         return distanceToLineSegment(point, a, b) <= (thickness + 20.0f);
     }
@@ -37,13 +48,17 @@ struct Circle2D : Shape2D {
 
     Circle2D(sf::Vector2f c, float r) : center(c), radius(r) {}
 
+    // Point count follows the radius (see appendCircle)
     void draw(sf::RenderWindow& window,
               sf::Color color = sf::Color::White) override {
-        sf::CircleShape sfCircle(radius);
-        sfCircle.setOrigin({radius, radius});
-        sfCircle.setPosition(center);
-        sfCircle.setFillColor(color);
-        window.draw(sfCircle);
+        sf::VertexArray vertices(sf::PrimitiveType::Triangles);
+        appendCircle(vertices, center, radius, color);
+        window.draw(vertices);
+    }
+
+    bool appendTo(Batcher2D& batcher, sf::Color color) override {
+        appendCircle(batcher.get(), center, radius, color);
+        return true;
     }
 
     bool computeCollisionWithPoint(sf::Vector2f point) override {
@@ -77,3 +92,49 @@ struct Text2D : Shape2D {
         return text.getGlobalBounds().contains(point);
     }
 };
+
+// Any number of triangles drawn with one draw call (batched lines, meshes...).
+// Vertex colors are multiplied by the draw color.
+struct Triangles2D : Shape2D {
+    sf::VertexArray vertices{sf::PrimitiveType::Triangles};
+    const sf::Texture* texture = nullptr;  // optional, for textured vertices
+
+    void draw(sf::RenderWindow& window,
+              sf::Color color = sf::Color::White) override {
+        if (color != sf::Color::White) {
+            for (std::size_t i = 0; i < vertices.getVertexCount(); i++) {
+                vertices[i].color = vertices[i].color * color;
+            }
+        }
+        window.draw(vertices, sf::RenderStates(texture));
+    }
+
+    bool appendTo(Batcher2D& batcher, sf::Color color) override {
+        sf::VertexArray& out = batcher.get(texture);
+        for (std::size_t i = 0; i < vertices.getVertexCount(); i++) {
+            sf::Vertex v = vertices[i];
+            if (color != sf::Color::White) v.color = v.color * color;
+            out.append(v);
+        }
+        return true;
+    }
+
+    bool computeCollisionWithPoint(sf::Vector2f point) override {
+        auto side = [](sf::Vector2f p, sf::Vector2f a, sf::Vector2f b) {
+            return (b.x - a.x) * (p.y - a.y) - (b.y - a.y) * (p.x - a.x);
+        };
+
+        for (std::size_t i = 0; i + 2 < vertices.getVertexCount(); i += 3) {
+            sf::Vector2f a = vertices[i].position;
+            sf::Vector2f b = vertices[i + 1].position;
+            sf::Vector2f c = vertices[i + 2].position;
+
+            float d1 = side(point, a, b), d2 = side(point, b, c),
+                  d3 = side(point, c, a);
+            bool has_neg = d1 < 0 || d2 < 0 || d3 < 0;
+            bool has_pos = d1 > 0 || d2 > 0 || d3 > 0;
+            if (!(has_neg && has_pos)) return true;
+        }
+        return false;
+    }
+};
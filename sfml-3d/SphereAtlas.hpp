@@ -0,0 +1,143 @@
+#pragma once
+/*
+SphereAtlas: shaded sphere images baked once into one texture, at a few
+sizes. Spheres are then drawn as textured quads tinted by their color, which
+looks lit but costs no more than a flat disc, and all of them batch into a
+single draw call.
+
+    SphereAtlas atlas;
+    SPHERE_SPRITES = &atlas;  // every Sphere3D now draws as a sprite
+*/
+
+#include <SFML/Graphics.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "Shape2D.hpp"
+
+struct SphereAtlas {
+    sf::Texture texture;
+    std::vector<unsigned int> sizes;  // diameters in pixels, ascending
+    std::vector<sf::IntRect> rects;   // where each size is in the texture
+
+    // Direction towards the light (screen space, z towards the viewer)
+    float lightX = -0.4f, lightY = -0.5f, lightZ = 0.77f;
+    float ambient = 0.25f;
+    float specular = 0.4f;
+    float shininess = 24.0f;
+
+    SphereAtlas(std::vector<unsigned int> s = {8, 16, 32, 64, 128})
+        : sizes(std::move(s)) {
+        std::sort(sizes.begin(), sizes.end());
+        build();
+    }
+
+    // Bakes every size side by side (1 pixel apart) into the texture
+    void build() {
+        rects.clear();
+        if (sizes.empty()) return;
+
+        unsigned int width = 0;
+        for (unsigned int size : sizes) width += size + 1;
+
+        sf::Image image;
+        image.resize({width, sizes.back()}, sf::Color::Transparent);
+
+        float length = std::sqrt(lightX * lightX + lightY * lightY + lightZ * lightZ);
+        float lx = lightX / length, ly = lightY / length, lz = lightZ / length;
+
+        // Blinn half vector between the light and the viewer (0, 0, 1)
+        float hx = lx, hy = ly, hz = lz + 1.0f;
+        float h_length = std::sqrt(hx * hx + hy * hy + hz * hz);
+        hx /= h_length, hy /= h_length, hz /= h_length;
+
+        unsigned int left = 0;
+        for (unsigned int size : sizes) {
+            const float half = size / 2.0f;
+
+            for (unsigned int y = 0; y < size; y++) {
+                for (unsigned int x = 0; x < size; x++) {
+                    float nx = (x + 0.5f - half) / half;
+                    float ny = (y + 0.5f - half) / half;
+                    float d = std::sqrt(nx * nx + ny * ny);
+
+                    // Antialiased edge: coverage of the pixel by the disc
+                    float coverage = std::clamp((1.0f - d) * half + 0.5f, 0.0f, 1.0f);
+                    if (coverage <= 0.0f) continue;
+
+                    float nz = std::sqrt(std::max(0.0f, 1.0f - std::min(d * d, 1.0f)));
+                    float diffuse = std::max(0.0f, nx * lx + ny * ly + nz * lz);
+                    float highlight = std::pow(std::max(0.0f, nx * hx + ny * hy + nz * hz), shininess);
+
+                    float shade = std::min(1.0f, ambient + (1.0f - ambient) * diffuse +
+                                                     specular * highlight);
+                    auto level = static_cast<std::uint8_t>(255.0f * shade);
+                    image.setPixel({left + x, y},
+                                   sf::Color(level, level, level,
+                                             static_cast<std::uint8_t>(255.0f * coverage)));
+                }
+            }
+
+            rects.push_back(sf::IntRect({static_cast<int>(left), 0},
+                                        {static_cast<int>(size), static_cast<int>(size)}));
+            left += size + 1;
+        }
+
+        if (!texture.loadFromImage(image)) return;
+        texture.setSmooth(true);
+    }
+
+    // Smallest baked size that covers the given radius (in pixels)
+    const sf::IntRect& rectFor(float radius) const {
+        for (std::size_t i = 0; i < sizes.size(); i++) {
+            if (sizes[i] >= 2.0f * radius) return rects[i];
+        }
+        return rects.back();
+    }
+
+    // Textured quad for a sphere of the given screen center and radius
+    void appendSprite(sf::VertexArray& vertices, sf::Vector2f center, float radius,
+                      sf::Color color) const {
+        ::appendSprite(vertices, center, {radius, radius}, rectFor(radius), color);
+    }
+};
+
+// A sphere drawn from a SphereAtlas, or as a flat circle (like Circle2D)
+// when atlas is null
+struct SphereSprite2D : Shape2D {
+    sf::Vector2f center;
+    float radius;
+    const SphereAtlas* atlas;
+
+    SphereSprite2D(sf::Vector2f c, float r, const SphereAtlas* a)
+        : center(c), radius(r), atlas(a) {}
+
+    void draw(sf::RenderWindow& window,
+              sf::Color color = sf::Color::White) override {
+        sf::VertexArray vertices(sf::PrimitiveType::Triangles);
+        if (!atlas) {
+            appendCircle(vertices, center, radius, color);
+            window.draw(vertices);
+            return;
+        }
+        atlas->appendSprite(vertices, center, radius, color);
+        window.draw(vertices, sf::RenderStates(&atlas->texture));
+    }
+
+    bool appendTo(Batcher2D& batcher, sf::Color color) override {
+        if (!atlas) {
+            appendCircle(batcher.get(), center, radius, color);
+        } else {
+            atlas->appendSprite(batcher.get(&atlas->texture), center, radius, color);
+        }
+        return true;
+    }
+
+    bool computeCollisionWithPoint(sf::Vector2f point) override {
+        sf::Vector2f diff = point - center;
+        return diff.x * diff.x + diff.y * diff.y <= radius * radius;
+    }
+};
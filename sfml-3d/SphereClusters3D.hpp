@@ -0,0 +1,247 @@
+#pragma once
+/*
+SphereClusters3D: a large static group of spheres drawn as one object. The
+spheres are binned into a grid of cells, and cells are merged 2x2x2 into
+coarser levels up to a single root. build() precomputes an impostor for every
+cell: one disc at its center of mass with the same total area as its spheres,
+in their average color. Drawing walks down from the root and stops at cells
+that are smaller than impostorRadius on screen, so the cost follows how much
+of the screen the group covers instead of how many spheres it has. Spheres
+smaller than MIN_PROJECTED_RADIUS are skipped.
+*/
+
+#include <SFML/Graphics.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "3d_camera.hpp"
+#include "Frustum.hpp"
+#include "Object3D.hpp"
+#include "ProjectedVertices.hpp"
+#include "Shape2D.hpp"
+#include "math4.hpp"
+
+struct SphereClusters3D : Object3D {
+    // build() groups these by cell
+    std::vector<vec4> positions;
+    std::vector<float> radii;
+    std::vector<sf::Color> colors;
+
+    float cellSize = 50.0f;
+    float impostorRadius = 4.0f;  // cells smaller than this on screen (pixels) draw one disc
+
+    struct Cell {
+        vec4 center;       // center of mass
+        float bound;       // radius of a sphere around center holding every sphere
+        float area;        // sum of the spheres' squared radii
+        sf::Color color;   // average color
+        int begin, end;    // children in the level below (spheres for level 0)
+    };
+    std::vector<std::vector<Cell>> levels;  // levels.back() holds the root
+    vec4 center;
+
+    SphereClusters3D(float cell = 50.0f) : cellSize(cell) {}
+
+    void add(vec4 position, float radius, sf::Color color = sf::Color::White) {
+        positions.push_back(position);
+        radii.push_back(radius);
+        colors.push_back(color);
+    }
+
+    void add(const Sphere3D& sphere, sf::Color color = sf::Color::White) {
+        add(sphere.position, sphere.radius, color);
+    }
+
+    // Call after adding or moving spheres
+    void build() {
+        levels.clear();
+        center = vec4();
+        const int n = static_cast<int>(positions.size());
+        if (n == 0) return;
+
+        // Cells in Morton order, so the cells of every coarser level cover
+        // contiguous ranges of the level below
+        int lo[3] = {0, 0, 0};
+        auto cellOf = [&](const vec4& p, int axis) {
+            float c = axis == 0 ? p.x : axis == 1 ? p.y : p.z;
+            return static_cast<int>(std::floor(c / cellSize));
+        };
+        for (int axis = 0; axis < 3; axis++) {
+            lo[axis] = cellOf(positions[0], axis);
+            for (const vec4& p : positions) lo[axis] = std::min(lo[axis], cellOf(p, axis));
+        }
+        auto morton = [&](const vec4& p) {
+            std::uint64_t code = 0;
+            for (int axis = 0; axis < 3; axis++) {
+                std::uint64_t c = static_cast<std::uint64_t>(cellOf(p, axis) - lo[axis]);
+                for (int bit = 0; bit < 21; bit++) {
+                    code |= ((c >> bit) & 1) << (3 * bit + axis);
+                }
+            }
+            return code;
+        };
+
+        std::vector<std::pair<std::uint64_t, int>> order(n);
+        for (int i = 0; i < n; i++) order[i] = {morton(positions[i]), i};
+        std::sort(order.begin(), order.end());
+
+        std::vector<vec4> sorted_positions(n);
+        std::vector<float> sorted_radii(n);
+        std::vector<sf::Color> sorted_colors(n);
+        for (int i = 0; i < n; i++) {
+            sorted_positions[i] = positions[order[i].second];
+            sorted_radii[i] = radii[order[i].second];
+            sorted_colors[i] = colors[order[i].second];
+        }
+        positions = std::move(sorted_positions);
+        radii = std::move(sorted_radii);
+        colors = std::move(sorted_colors);
+
+        // Level 0 from the spheres; codes are kept per cell for merging
+        std::vector<std::uint64_t> codes;
+        levels.emplace_back();
+        for (int begin = 0; begin < n;) {
+            int end = begin + 1;
+            while (end < n && order[end].first == order[begin].first) end++;
+
+            std::vector<Cell> spheres;
+            for (int i = begin; i < end; i++) {
+                sf::Color c = colors[i];
+                spheres.push_back({positions[i], radii[i], radii[i] * radii[i], c, i, i + 1});
+            }
+            levels[0].push_back(merge(spheres.data(), spheres.size(), begin, end));
+            codes.push_back(order[begin].first);
+            begin = end;
+        }
+
+        // Coarser levels until a single root
+        while (levels.back().size() > 1) {
+            const std::vector<Cell>& below = levels.back();
+            std::vector<Cell> level;
+            std::vector<std::uint64_t> next_codes;
+
+            for (int begin = 0; begin < static_cast<int>(below.size());) {
+                int end = begin + 1;
+                while (end < static_cast<int>(below.size()) &&
+                       codes[end] >> 3 == codes[begin] >> 3)
+                    end++;
+                level.push_back(merge(&below[begin], end - begin, begin, end));
+                next_codes.push_back(codes[begin] >> 3);
+                begin = end;
+            }
+            levels.push_back(std::move(level));
+            codes = std::move(next_codes);
+        }
+        center = levels.back()[0].center;
+    }
+
+    // Impostor for a group of cells (or single spheres)
+    static Cell merge(const Cell* parts, std::size_t count, int begin, int end) {
+        Cell cell{vec4(), 0.0f, 0.0f, sf::Color::White, begin, end};
+        float r = 0.0f, g = 0.0f, b = 0.0f, a = 0.0f;
+        for (std::size_t i = 0; i < count; i++) {
+            vec4 c = parts[i].center;
+            float w = parts[i].area;
+            cell.center += c * w;
+            cell.area += w;
+            r += parts[i].color.r * w;
+            g += parts[i].color.g * w;
+            b += parts[i].color.b * w;
+            a += parts[i].color.a * w;
+        }
+        if (cell.area > 0.0f) {
+            cell.center /= cell.area;
+            cell.color = sf::Color(static_cast<std::uint8_t>(r / cell.area),
+                                   static_cast<std::uint8_t>(g / cell.area),
+                                   static_cast<std::uint8_t>(b / cell.area),
+                                   static_cast<std::uint8_t>(a / cell.area));
+        } else {
+            cell.center = parts[0].center;
+        }
+        for (std::size_t i = 0; i < count; i++) {
+            vec4 c = parts[i].center;
+            cell.bound = std::max(cell.bound, (c - cell.center).magnitude() + parts[i].bound);
+        }
+        return cell;
+    }
+
+    float calculateDistance(const Camera& camera) override {
+        return (camera.cf.get_position() - center).magnitude();
+    }
+
+    // Disc for a sphere (or impostor) of the given projected radius. Below
+    // a pixel it fades out instead of shrinking further.
+    static void appendDisc(Triangles2D& shape, sf::Vector2f p, float r,
+                           sf::Color color) {
+        if (r < 0.5f) {
+            color.a = static_cast<std::uint8_t>(color.a * std::min(1.0f, 4.0f * r * r));
+            appendPoint(shape.vertices, p, 1.0f, color);
+        } else {
+            appendCircle(shape.vertices, p, r, color);
+        }
+    }
+
+    std::unique_ptr<Shape2D> computeShape(sf::RenderWindow& window,
+                                          const Camera& camera) override {
+        if (levels.empty()) return nullptr;
+
+        const mat4 inv = camera.cf.inverse_rigid();
+        const Frustum frustum(window, camera, NEAR, FAR_PLANE, 0.0f);
+
+        // Discs to draw: depth key, view position, world radius, color
+        struct Disc {
+            float key;
+            vec4 view;
+            float radius;
+            sf::Color color;
+        };
+        std::vector<Disc> discs;
+
+        std::vector<std::pair<int, int>> stack = {
+            {static_cast<int>(levels.size()) - 1, 0}};  // level, cell
+        while (!stack.empty()) {
+            auto [level, c] = stack.back();
+            stack.pop_back();
+            const Cell& cell = levels[level][c];
+
+            mat4 m = inv;
+            vec4 v = m * cell.center;
+            if (!frustum.intersectsSphere(v, cell.bound)) continue;
+
+            bool in_front = v.z - cell.bound > NEAR;
+            if (in_front && camera.FOV * cell.bound / v.z < impostorRadius) {
+                discs.push_back({v.magnitudeSquared(), v, std::sqrt(cell.area), cell.color});
+                continue;
+            }
+
+            if (level > 0) {
+                for (int i = cell.begin; i < cell.end; i++) stack.push_back({level - 1, i});
+                continue;
+            }
+
+            // Close enough to draw the spheres themselves
+            for (int i = cell.begin; i < cell.end; i++) {
+                vec4 p = m * positions[i];
+                if (p.z <= NEAR) continue;
+                if (camera.FOV * radii[i] / p.z < MIN_PROJECTED_RADIUS) continue;
+                discs.push_back({p.magnitudeSquared(), p, radii[i], colors[i]});
+            }
+        }
+
+        std::sort(discs.begin(), discs.end(),
+                  [](const Disc& a, const Disc& b) { return a.key > b.key; });
+
+        auto shape = std::make_unique<Triangles2D>();
+        for (const Disc& disc : discs) {
+            appendDisc(*shape, ProjectedVertices::project(window, camera, disc.view),
+                       camera.FOV * disc.radius / disc.view.z, disc.color);
+        }
+
+        if (shape->vertices.getVertexCount() == 0) return nullptr;
+        return shape;
+    }
+};
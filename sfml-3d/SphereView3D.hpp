@@ -0,0 +1,154 @@
+#pragma once
+/*
+SphereView3D: spheres read straight from the caller's arrays through
+StridedViews, drawn as one object. Nothing is copied, so a simulation can
+keep its own layout and the engine reads it in place every frame.
+
+Projections are cached per sphere. While the view stays the same only the
+ranges passed to markDirty(begin, end) are projected again, and a frame with
+nothing dirty reuses the visible list without scanning or sorting; a new view
+projects everything. Call markDirty after changing the data, setCount if the
+number of spheres changes (or assign new views if the arrays moved), and
+change radius / color through setRadius / setColor.
+
+    std::vector<Body> bodies = ...;
+    SphereView3D view(StridedView<Float3>(&bodies[0].x, bodies.size(), sizeof(Body)));
+    view.radius = 0.5f;
+    ...
+    simulate(bodies, 0, 1000);
+    view.markDirty(0, 1000);
+*/
+
+#include <SFML/Graphics.hpp>
+#include <algorithm>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "3d_camera.hpp"
+#include "Frustum.hpp"
+#include "Object3D.hpp"
+#include "Parallel.hpp"
+#include "ProjectedPoints.hpp"
+#include "Shape2D.hpp"
+#include "SphereAtlas.hpp"
+#include "StridedView.hpp"
+#include "math4.hpp"
+
+struct SphereView3D : Object3D {
+    StridedView<Float3> positions;
+    StridedView<float> radii;       // optional, radius is used when empty
+    StridedView<sf::Color> colors;  // optional, color is used when empty
+    float radius = 1.0f;
+    sf::Color color = sf::Color::White;
+
+    vec4 origin;  // depth key when sorted in a collection
+
+    // Below this many spheres projection runs on the calling thread
+    std::size_t parallelThreshold = 65536;
+
+    // Depth (0 when culled), x, y and pixel radius of every sphere
+    ProjectedPoints projected;
+    ViewKey key;
+    std::vector<std::pair<std::size_t, std::size_t>> dirty;
+    bool gathered = false;  // projected.visible matches projected
+
+    SphereView3D() = default;
+    SphereView3D(StridedView<Float3> p, StridedView<float> r = {},
+                 StridedView<sf::Color> c = {})
+        : positions(p), radii(r), colors(c) {}
+
+    std::size_t size() const { return positions.count; }
+
+    // Call when the number of spheres changed
+    void setCount(std::size_t n) {
+        positions.count = n;
+        if (!radii.empty()) radii.count = n;
+        if (!colors.empty()) colors.count = n;
+        markDirty();
+    }
+
+    // Spheres [begin, end) changed
+    void markDirty(std::size_t begin, std::size_t end) {
+        end = std::min(end, size());
+        if (begin < end) dirty.push_back({begin, end});
+    }
+
+    void markDirty() { key.invalidate(); }
+
+    void setRadius(float r) {
+        radius = r;
+        markDirty();
+    }
+
+    void setColor(sf::Color c) {
+        color = c;
+        markDirty();
+    }
+
+    float calculateDistance(const Camera& camera) override {
+        return (camera.cf.get_position() - origin).magnitude();
+    }
+
+    // Projects spheres [begin, end) into projected
+    void project(std::size_t begin, std::size_t end, const ProjectedPoints::View& view) {
+        const bool own_radius = !radii.empty();
+        auto half = [](float r) { return sf::Vector2f(r, r); };
+
+        for (std::size_t i = begin; i < end; i++) {
+            const Float3 p = positions[i];
+            projected.project(i, p.x, p.y, p.z, own_radius ? radii[i] : radius,
+                              MIN_PROJECTED_RADIUS, view, half);
+        }
+    }
+
+    // Brings projected up to date with the view and the dirty ranges.
+    // Returns false when nothing had to be projected again.
+    bool update(sf::RenderWindow& window, const Camera& camera) {
+        const std::size_t n = size();
+        const ProjectedPoints::View view(window, camera);
+        auto projectRange = [&](std::size_t b, std::size_t e) { project(b, e, view); };
+
+        bool changed = !dirty.empty();
+        if (!key.matches(window, camera) || projected.size() != n) {
+            key.set(window, camera);
+            projected.resize(n);
+            parallelFor(0, n, projectRange, parallelThreshold);
+            changed = true;
+        } else {
+            for (const auto& [b, e] : dirty) {
+                parallelFor(b, std::min(e, n), projectRange, parallelThreshold);
+            }
+        }
+        dirty.clear();
+        return changed;
+    }
+
+    std::unique_ptr<Shape2D> computeShape(sf::RenderWindow& window,
+                                          const Camera& camera) override {
+        if (positions.empty()) return nullptr;
+        if (update(window, camera) || !gathered) {
+            projected.gather();
+            gathered = true;
+        }
+
+        const std::vector<int>& visible = projected.visible;
+        if (visible.empty()) return nullptr;
+
+        auto shape = std::make_unique<Triangles2D>();
+        if (SPHERE_SPRITES) shape->texture = &SPHERE_SPRITES->texture;
+
+        for (int i : visible) {
+            sf::Vector2f p = projected.position(i);
+            float r = projected.pixelSize(i);
+            sf::Color c = colors.empty() ? color : colors[i];
+
+            if (SPHERE_SPRITES) {
+                SPHERE_SPRITES->appendSprite(shape->vertices, p, r, c);
+            } else {
+                appendCircle(shape->vertices, p, r, c);
+            }
+        }
+        return shape;
+    }
+};
@@ -0,0 +1,176 @@
+#pragma once
+/*
+Sprite3D: a billboard showing a sub-rectangle of a texture atlas at a 3D
+position, always facing the camera and scaled with distance like Sphere3D.
+Drawn through Object3D_Collection::draw, consecutive sprites sharing a
+texture end up in the same draw call.
+
+SpriteSet3D: many sprites from one atlas as a single object. All of them are
+projected in one pass and written into one vertex array, so 100k markers cost
+one draw call.
+
+    SpriteSet3D markers(&atlasTexture);
+    int pin = markers.addFrame(sf::IntRect({0, 0}, {32, 32}));
+    markers.add(vec4(10, 0, 50), 2.0f, pin);
+*/
+
+#include <SFML/Graphics.hpp>
+#include <algorithm>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "3d_camera.hpp"
+#include "Object3D.hpp"
+#include "Parallel.hpp"
+#include "ProjectedPoints.hpp"
+#include "Shape2D.hpp"
+#include "math4.hpp"
+
+// Screen half extent of a sprite of the given world height; the width
+// follows the aspect ratio of its rectangle
+sf::Vector2f spriteHalfExtent(const sf::IntRect& rect, float pixel_height) {
+    float half_height = pixel_height / 2.0f;
+    float aspect = rect.size.y != 0 ? static_cast<float>(rect.size.x) / rect.size.y : 1.0f;
+    return {half_height * aspect, half_height};
+}
+
+struct Sprite3D : Object3D {
+    vec4 position;
+    float size = 1.0f;  // world-space height
+    const sf::Texture* texture = nullptr;
+    sf::IntRect rect;   // sub-rectangle of texture, in pixels
+
+    Sprite3D() = default;
+    Sprite3D(vec4 pos, float s, const sf::Texture* t, sf::IntRect r)
+        : position(pos), size(s), texture(t), rect(r) {}
+
+    float calculateDistance(const Camera& camera) override {
+        return (camera.cf.get_position() - position).magnitude();
+    }
+
+    std::unique_ptr<Shape2D> computeShape(sf::RenderWindow& window,
+                                          const Camera& camera) override {
+        mat4 camera_inverse = camera.cf.inverse_rigid();
+        vec4 view_pos = camera_inverse * position;
+
+        if (view_pos.z <= NEAR) return nullptr;
+
+        float pixel_height = camera.FOV * size / view_pos.z;
+        if (pixel_height < 2.0f * MIN_PROJECTED_RADIUS) return nullptr;
+
+        sf::Vector2f screen_pos =
+            normalize_point(window, convert_3d_to_2d(view_pos, camera));
+
+        auto shape = std::make_unique<Triangles2D>();
+        shape->texture = texture;
+        appendSprite(shape->vertices, screen_pos, spriteHalfExtent(rect, pixel_height),
+                     rect);
+        return shape;
+    }
+};
+
+struct SpriteSet3D : Object3D {
+    const sf::Texture* texture = nullptr;
+    std::vector<sf::IntRect> frames;  // sub-rectangles of texture, in pixels
+
+    // One entry per sprite
+    std::vector<vec4> positions;
+    std::vector<float> sizes;  // world-space heights
+    std::vector<int> frameOf;  // index into frames
+    std::vector<sf::Color> colors;
+
+    bool sortByDepth = true;  // back to front, for sprites with transparency
+
+    // Below this many sprites projection runs on the calling thread
+    std::size_t parallelThreshold = 65536;
+
+    // Depth (0 when culled), x, y and pixel height of every sprite, filled
+    // by computeShape
+    ProjectedPoints projected;
+
+    vec4 position_sum;  // for the depth key
+
+    SpriteSet3D() = default;
+    SpriteSet3D(const sf::Texture* t) : texture(t) {}
+
+    int addFrame(sf::IntRect rect) {
+        frames.push_back(rect);
+        return static_cast<int>(frames.size()) - 1;
+    }
+
+    // Returns the sprite's index, or -1 (nothing added) if frame is not an
+    // index into frames
+    int add(vec4 position, float size, int frame,
+            sf::Color color = sf::Color::White) {
+        if (frame < 0 || frame >= static_cast<int>(frames.size())) return -1;
+        positions.push_back(position);
+        sizes.push_back(size);
+        frameOf.push_back(frame);
+        colors.push_back(color);
+        position_sum += position;
+        return static_cast<int>(positions.size()) - 1;
+    }
+
+    void setPosition(int i, vec4 position) {
+        position_sum += position - positions[i];
+        positions[i] = position;
+    }
+
+    void clear() {
+        positions.clear();
+        sizes.clear();
+        frameOf.clear();
+        colors.clear();
+        position_sum = vec4();
+    }
+
+    std::size_t size() const { return positions.size(); }
+
+    vec4 center() const {
+        if (positions.empty()) return vec4();
+        vec4 sum = position_sum;
+        return sum / static_cast<float>(positions.size());
+    }
+
+    float calculateDistance(const Camera& camera) override {
+        return (camera.cf.get_position() - center()).magnitude();
+    }
+
+    // Projects sprites [begin, end) into projected
+    void project(std::size_t begin, std::size_t end, const ProjectedPoints::View& view) {
+        for (std::size_t i = begin; i < end; i++) {
+            const vec4& p = positions[i];
+            const sf::IntRect& rect = frames[frameOf[i]];
+            projected.project(i, p.x, p.y, p.z, sizes[i], 2.0f * MIN_PROJECTED_RADIUS, view,
+                              [&](float s) { return spriteHalfExtent(rect, s); });
+        }
+    }
+
+    std::unique_ptr<Shape2D> computeShape(sf::RenderWindow& window,
+                                          const Camera& camera) override {
+        const ProjectedPoints::View view(window, camera);
+        projected.resize(positions.size());
+        parallelFor(0, positions.size(), [&](std::size_t b, std::size_t e) {
+            project(b, e, view);
+        }, parallelThreshold);
+
+        projected.gather(sortByDepth);
+        const std::vector<int>& visible = projected.visible;
+        if (visible.empty()) return nullptr;
+
+        // Sized once and written in place instead of growing with append
+        auto shape = std::make_unique<Triangles2D>();
+        shape->texture = texture;
+        shape->vertices.resize(visible.size() * 6);
+
+        std::size_t k = 0;
+        for (int i : visible) {
+            const sf::IntRect& r = frames[frameOf[i]];
+            appendSprite(shape->vertices, k, projected.position(i),
+                         spriteHalfExtent(r, projected.pixelSize(i)), r, colors[i]);
+            k += 6;
+        }
+        return shape;
+    }
+};
@@ -0,0 +1,44 @@
+#pragma once
+/*
+StridedView: read-only access to count values of type T that are stride
+bytes apart in memory the caller owns, such as one field of an array of
+structs. The memory must outlive the view. Elements are read by value with
+memcpy, so T only has to match the bytes (three floats for Float3), not the
+declared type of the caller's fields.
+
+    struct Body { float x, y, z; float vx, vy, vz; float mass; };
+    std::vector<Body> bodies = ...;
+    StridedView<Float3> positions(&bodies[0].x, bodies.size(), sizeof(Body));
+    StridedView<float> masses(&bodies[0].mass, bodies.size(), sizeof(Body));
+*/
+
+#include <cstddef>
+#include <cstring>
+#include <type_traits>
+
+// Three consecutive floats (x, y, z), e.g. the start of a vec4
+struct Float3 {
+    float x, y, z;
+};
+
+template <typename T>
+struct StridedView {
+    static_assert(std::is_trivially_copyable_v<T>, "StridedView reads T with memcpy");
+
+    const unsigned char* data = nullptr;
+    std::size_t stride = sizeof(T);
+    std::size_t count = 0;
+
+    StridedView() = default;
+    StridedView(const void* first, std::size_t n, std::size_t s = sizeof(T))
+        : data(static_cast<const unsigned char*>(first)), stride(s), count(n) {}
+
+    T operator[](std::size_t i) const {
+        T value;
+        std::memcpy(&value, data + i * stride, sizeof(T));
+        return value;
+    }
+
+    std::size_t size() const { return count; }
+    bool empty() const { return data == nullptr || count == 0; }
+};
@@ -0,0 +1,219 @@
+#pragma once
+/*
+Surface3D: a height field z = f(x, y) sampled on a regular grid. Grid points
+are shared vertices and edges/faces are implied by the grid, so nothing is
+duplicated. Changed samples are tracked as a dirty rectangle and only those
+rows and columns are transformed again while the view stays the same.
+
+    Surface3D surface(101, 101, vec4(-50, -50, 0), 1.0f, 1.0f);
+    surface.sample([](float x, float y) { return 10 * std::sin(x * y / 100); });
+    surface.setHeight(20, 30, 5.0f);  // only this vertex is re-projected
+*/
+
+#include <SFML/Graphics.hpp>
+#include <algorithm>
+#include <functional>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "3d_camera.hpp"
+#include "Frustum.hpp"
+#include "Object3D.hpp"
+#include "ProjectedVertices.hpp"
+#include "Shape2D.hpp"
+#include "Wireframe3D.hpp"
+#include "math4.hpp"
+
+struct Surface3D : Object3D {
+    int columns = 0, rows = 0;  // samples along x and y
+    vec4 origin;                // position of sample (0, 0) at height 0
+    float spacingX = 1.0f, spacingY = 1.0f;
+
+    std::vector<vec4> vertices;  // rows * columns, row by row
+
+    float thickness = 1.0f;
+    sf::Color fillColor = sf::Color(128, 128, 128);
+    sf::Color edgeColor = sf::Color::White;
+    bool drawFaces = true;
+    bool drawEdges = true;
+
+    ProjectedVertices projected;
+
+    // Samples changed since the last prepare(), inclusive; empty if c0 > c1
+    int dirty_c0 = 1, dirty_r0 = 1, dirty_c1 = 0, dirty_r1 = 0;
+
+    Surface3D() = default;
+    Surface3D(int c, int r, vec4 o = vec4(), float sx = 1.0f, float sy = 1.0f)
+        : columns(c), rows(r), origin(o), spacingX(sx), spacingY(sy) {
+        vertices.resize(static_cast<std::size_t>(columns) * rows);
+        for (int j = 0; j < rows; j++) {
+            for (int i = 0; i < columns; i++) {
+                vertices[index(i, j)] =
+                    vec4(origin.x + i * spacingX, origin.y + j * spacingY, origin.z);
+            }
+        }
+    }
+
+    int index(int c, int r) const { return r * columns + c; }
+
+    float getHeight(int c, int r) const { return vertices[index(c, r)].z - origin.z; }
+
+    void setHeight(int c, int r, float h) {
+        vertices[index(c, r)].z = origin.z + h;
+        markDirty(c, r, c, r);
+    }
+
+    // Evaluates f(x, y) for the samples in [c0, c1] x [r0, r1]
+    void sample(const std::function<float(float, float)>& f, int c0, int r0,
+                int c1, int r1) {
+        for (int j = r0; j <= r1; j++) {
+            for (int i = c0; i <= c1; i++) {
+                vec4& v = vertices[index(i, j)];
+                v.z = origin.z + f(v.x - origin.x, v.y - origin.y);
+            }
+        }
+        markDirty(c0, r0, c1, r1);
+    }
+
+    void sample(const std::function<float(float, float)>& f) {
+        sample(f, 0, 0, columns - 1, rows - 1);
+    }
+
+    // Grows the dirty rectangle to include [c0, c1] x [r0, r1]
+    void markDirty(int c0, int r0, int c1, int r1) {
+        if (dirty_c0 > dirty_c1) {
+            dirty_c0 = c0, dirty_r0 = r0, dirty_c1 = c1, dirty_r1 = r1;
+            return;
+        }
+        dirty_c0 = std::min(dirty_c0, c0);
+        dirty_r0 = std::min(dirty_r0, r0);
+        dirty_c1 = std::max(dirty_c1, c1);
+        dirty_r1 = std::max(dirty_r1, r1);
+    }
+
+    void prepare(sf::RenderWindow& window, const Camera& camera) {
+        bool dirty = dirty_c0 <= dirty_c1;
+
+        if (!projected.update(vertices, window, camera, thickness) && dirty) {
+            // Same view: only the changed part of each changed row
+            const mat4 inv = camera.cf.inverse_rigid();
+            for (int j = dirty_r0; j <= dirty_r1; j++) {
+                projected.transformRange(vertices.data(), index(dirty_c0, j),
+                                         index(dirty_c1, j) + 1, inv, window,
+                                         camera, thickness);
+            }
+        }
+        dirty_c0 = 1, dirty_c1 = 0;
+    }
+
+    // The two triangles of cell (c, r), clipped at the near plane
+    void appendCell(Triangles2D& shape, sf::RenderWindow& window,
+                    const Camera& camera, int c, int r, sf::Color color) {
+        const int tris[2][3] = {
+            {index(c, r), index(c + 1, r), index(c + 1, r + 1)},
+            {index(c, r), index(c + 1, r + 1), index(c, r + 1)}};
+
+        for (const auto& tri : tris) {
+            if (projected.in_front[tri[0]] && projected.in_front[tri[1]] &&
+                projected.in_front[tri[2]]) {
+                for (int k = 0; k < 3; k++) {
+                    shape.vertices.append({projected.screen[tri[k]], color});
+                }
+                continue;
+            }
+
+            vec4 in[3] = {projected.view[tri[0]], projected.view[tri[1]],
+                          projected.view[tri[2]]};
+            vec4 clipped[4];
+            int count = Mesh3D::clipNear(in, 3, clipped);
+
+            for (int k = 1; k + 1 < count; k++) {
+                shape.vertices.append({ProjectedVertices::project(window, camera, clipped[0]), color});
+                shape.vertices.append({ProjectedVertices::project(window, camera, clipped[k]), color});
+                shape.vertices.append({ProjectedVertices::project(window, camera, clipped[k + 1]), color});
+            }
+        }
+    }
+
+    void appendEdge(Triangles2D& shape, const Frustum& frustum,
+                    sf::RenderWindow& window, const Camera& camera, int i, int j,
+                    sf::Color color) {
+        sf::Vector2f a_, b_;
+        if (projected.segment(i, j, frustum, window, camera, a_, b_)) {
+            appendLine(shape.vertices, a_, b_, thickness, color);
+        }
+    }
+
+    // Edges owned by cell (c, r): its top and left edges, plus the right and
+    // bottom ones along the far border of the grid
+    void appendCellEdges(Triangles2D& shape, const Frustum& frustum,
+                         sf::RenderWindow& window, const Camera& camera, int c,
+                         int r, sf::Color color) {
+        appendEdge(shape, frustum, window, camera, index(c, r), index(c + 1, r), color);
+        appendEdge(shape, frustum, window, camera, index(c, r), index(c, r + 1), color);
+        if (c + 2 == columns) {
+            appendEdge(shape, frustum, window, camera, index(c + 1, r),
+                       index(c + 1, r + 1), color);
+        }
+        if (r + 2 == rows) {
+            appendEdge(shape, frustum, window, camera, index(c, r + 1),
+                       index(c + 1, r + 1), color);
+        }
+    }
+
+    // Cells are drawn far to near, each with its own edges, so nearer parts
+    // of the surface hide the edges behind them
+    void appendTo(Triangles2D& shape, sf::RenderWindow& window,
+                  const Camera& camera, sf::Color tint = sf::Color::White) {
+        if (columns < 2 || rows < 2) return;
+
+        const Frustum frustum(window, camera, NEAR, FAR_PLANE, thickness);
+        const sf::Color face = fillColor * tint;
+        const sf::Color edge = edgeColor * tint;
+        auto& view = projected.view;
+        auto& in_front = projected.in_front;
+
+        std::vector<std::pair<float, int>> order;
+        order.reserve(static_cast<std::size_t>(columns - 1) * (rows - 1));
+        for (int r = 0; r + 1 < rows; r++) {
+            for (int c = 0; c + 1 < columns; c++) {
+                int i00 = index(c, r), i10 = index(c + 1, r);
+                int i01 = index(c, r + 1), i11 = index(c + 1, r + 1);
+                if (!in_front[i00] && !in_front[i10] && !in_front[i01] && !in_front[i11])
+                    continue;
+
+                vec4 mid = (view[i00] + view[i10] + view[i01] + view[i11]) * 0.25f;
+                order.push_back({mid.magnitudeSquared(), i00});
+            }
+        }
+        if (drawFaces) {
+            std::sort(order.begin(), order.end(),
+                      [](const auto& a, const auto& b) { return a.first > b.first; });
+        }
+
+        for (const auto& [key, i] : order) {
+            int c = i % columns, r = i / columns;
+            if (drawFaces) appendCell(shape, window, camera, c, r, face);
+            if (drawEdges) appendCellEdges(shape, frustum, window, camera, c, r, edge);
+        }
+    }
+
+    // Depth key: the middle of the grid
+    float calculateDistance(const Camera& camera) override {
+        if (vertices.empty()) return 0.0f;
+        return (camera.cf.get_position() - vertices[index(columns / 2, rows / 2)])
+            .magnitude();
+    }
+
+    std::unique_ptr<Shape2D> computeShape(sf::RenderWindow& window,
+                                          const Camera& camera) override {
+        prepare(window, camera);
+
+        auto shape = std::make_unique<Triangles2D>();
+        appendTo(*shape, window, camera);
+
+        if (shape->vertices.getVertexCount() == 0) return nullptr;
+        return shape;
+    }
+};
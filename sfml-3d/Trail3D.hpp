@@ -0,0 +1,174 @@
+#pragma once
+/*
+Trail3D: the last N positions of a moving entity, kept in a fixed-capacity
+ring buffer. push() is O(1) and never allocates, so trails can be fed at a
+much higher rate than they are drawn. Older points fade out.
+
+TrailSet3D draws many trails as a single object with one vertex array.
+*/
+
+#include <SFML/Graphics.hpp>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "3d_camera.hpp"
+#include "Frustum.hpp"
+#include "Object3D.hpp"
+#include "ProjectedVertices.hpp"
+#include "Shape2D.hpp"
+#include "math4.hpp"
+
+struct Trail3D : Object3D {
+    std::vector<vec4> points;  // ring buffer, sized to the capacity once
+    std::size_t head = 0;      // slot of the oldest point
+    std::size_t count = 0;
+
+    float thickness = 1.0f;
+    sf::Color color = sf::Color::White;
+    bool fade = true;  // alpha goes from 0 at the oldest point to color.a
+
+    // Scratch for the visible run being drawn, reserved up front
+    std::vector<sf::Vector2f> run;
+    std::vector<sf::Color> run_colors;
+
+    Trail3D(std::size_t capacity = 64, float t = 1.0f,
+            sf::Color c = sf::Color::White)
+        : points(capacity), thickness(t), color(c) {
+        run.reserve(capacity);
+        run_colors.reserve(capacity);
+    }
+
+    std::size_t capacity() const { return points.size(); }
+    std::size_t size() const { return count; }
+
+    // i = 0 is the oldest point
+    const vec4& at(std::size_t i) const {
+        std::size_t slot = head + i;
+        if (slot >= points.size()) slot -= points.size();
+        return points[slot];
+    }
+    const vec4& newest() const { return at(count - 1); }
+
+    // Appends a position, dropping the oldest one when full
+    void push(vec4 p) {
+        if (points.empty()) return;
+
+        if (count < points.size()) {
+            std::size_t slot = head + count;
+            if (slot >= points.size()) slot -= points.size();
+            points[slot] = p;
+            count++;
+        } else {
+            points[head] = p;
+            head = head + 1 == points.size() ? 0 : head + 1;
+        }
+    }
+
+    void clear() {
+        head = 0;
+        count = 0;
+    }
+
+    sf::Color colorAt(std::size_t i) const {
+        if (!fade || count < 2) return color;
+        sf::Color c = color;
+        c.a = static_cast<std::uint8_t>(color.a * i / (count - 1));
+        return c;
+    }
+
+    // Appends the trail as mitered strips, one per run inside the frustum.
+    // Every point is transformed once.
+    void appendTo(Triangles2D& shape, sf::RenderWindow& window,
+                  const Camera& camera) {
+        if (count < 2) return;
+
+        const mat4 inv = camera.cf.inverse_rigid();
+        const Frustum frustum(window, camera, NEAR, FAR_PLANE, thickness);
+
+        auto flush = [&]() {
+            appendPolyline(shape.vertices, run.data(), run.size(), thickness,
+                           color, run_colors.data());
+            run.clear();
+            run_colors.clear();
+        };
+
+        mat4 m = inv;
+        vec4 prev = m * at(0);
+        run.clear();
+        run_colors.clear();
+
+        for (std::size_t i = 1; i < count; i++) {
+            vec4 start = prev, end = m * at(i);
+            vec4 a = start, b = end;
+            prev = end;
+
+            if (!frustum.clipSegment(a, b)) {
+                flush();
+                continue;
+            }
+
+            bool clipped_a = !(a == start), clipped_b = !(b == end);
+            if (run.empty() || clipped_a) {
+                flush();
+                run.push_back(ProjectedVertices::project(window, camera, a));
+                run_colors.push_back(colorAt(i - 1));
+            }
+            run.push_back(ProjectedVertices::project(window, camera, b));
+            run_colors.push_back(colorAt(i));
+            if (clipped_b) flush();
+        }
+        flush();
+    }
+
+    // Distance to the newest point, where the entity is
+    float calculateDistance(const Camera& camera) override {
+        if (count == 0) return 0.0f;
+        return (camera.cf.get_position() - newest()).magnitude();
+    }
+
+    std::unique_ptr<Shape2D> computeShape(sf::RenderWindow& window,
+                                          const Camera& camera) override {
+        auto shape = std::make_unique<Triangles2D>();
+        appendTo(*shape, window, camera);
+
+        if (shape->vertices.getVertexCount() == 0) return nullptr;
+        return shape;
+    }
+};
+
+// Many trails drawn as one object (e.g. all tracked entities)
+struct TrailSet3D : Object3D {
+    std::vector<Trail3D> trails;
+
+    TrailSet3D() = default;
+    TrailSet3D(std::size_t trail_count, std::size_t capacity, float thickness = 1.0f,
+               sf::Color color = sf::Color::White) {
+        // Constructed in place: copies would drop the reserved run capacity
+        trails.reserve(trail_count);
+        for (std::size_t i = 0; i < trail_count; i++) {
+            trails.emplace_back(capacity, thickness, color);
+        }
+    }
+
+    void push(std::size_t trail, vec4 p) { trails[trail].push(p); }
+
+    float calculateDistance(const Camera& camera) override {
+        float best = -1.0f;
+        for (Trail3D& trail : trails) {
+            if (trail.count == 0) continue;
+            float d = trail.calculateDistance(camera);
+            if (best < 0.0f || d < best) best = d;
+        }
+        return best < 0.0f ? 0.0f : best;
+    }
+
+    std::unique_ptr<Shape2D> computeShape(sf::RenderWindow& window,
+                                          const Camera& camera) override {
+        auto shape = std::make_unique<Triangles2D>();
+        for (Trail3D& trail : trails) trail.appendTo(*shape, window, camera);
+
+        if (shape->vertices.getVertexCount() == 0) return nullptr;
+        return shape;
+    }
+};
@@ -0,0 +1,198 @@
+#pragma once
+/*
+VoxelGrid3D: outline of an occupancy grid, drawn with only the edges that are
+visible on its boundary. A lattice edge is shared by four voxels; it is kept
+when it lies on a silhouette or crease (1 or 3 of them occupied, or 2 on a
+diagonal) and dropped when it is hidden inside the volume or lies in the
+middle of a flat face. Consecutive kept edges on a line are merged into one
+segment.
+
+Edges are extracted per chunk of chunkSize^3 lattice points; setting a voxel
+only re-extracts the chunks touching it.
+
+    VoxelGrid3D grid(64, 64, 64, vec4(-32, -32, -32), 1.0f);
+    grid.set(3, 4, 5, true);
+*/
+
+#include <SFML/Graphics.hpp>
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "3d_camera.hpp"
+#include "Object3D.hpp"
+#include "Shape2D.hpp"
+#include "Wireframe3D.hpp"
+#include "math4.hpp"
+
+struct VoxelGrid3D : Object3D {
+    int nx = 0, ny = 0, nz = 0;  // voxels per axis
+    vec4 origin;                 // corner of voxel (0, 0, 0)
+    float voxelSize = 1.0f;
+    std::vector<std::uint8_t> occupied;
+
+    int chunkSize = 16;  // lattice points per chunk along each axis
+    int cx = 0, cy = 0, cz = 0;
+
+    struct Chunk {
+        std::vector<std::array<vec4, 2>> segments;
+        bool dirty = true;
+    };
+    std::vector<Chunk> chunks;
+
+    Wireframe3D wireframe;  // all chunks' segments, rebuilt when any changes
+    bool wireframe_dirty = true;
+
+    VoxelGrid3D() = default;
+    VoxelGrid3D(int x, int y, int z, vec4 o = vec4(), float size = 1.0f,
+                float thickness = 1.0f)
+        : nx(x), ny(y), nz(z), origin(o), voxelSize(size),
+          occupied(static_cast<std::size_t>(x) * y * z, 0) {
+        wireframe.thickness = thickness;
+        resizeChunks();
+    }
+
+    // The lattice has one more point than there are voxels along each axis
+    void resizeChunks() {
+        cx = nx / chunkSize + 1;
+        cy = ny / chunkSize + 1;
+        cz = nz / chunkSize + 1;
+        chunks.assign(static_cast<std::size_t>(cx) * cy * cz, Chunk());
+        wireframe_dirty = true;
+    }
+
+    int index(int x, int y, int z) const { return (z * ny + y) * nx + x; }
+
+    bool get(int x, int y, int z) const {
+        if (x < 0 || y < 0 || z < 0 || x >= nx || y >= ny || z >= nz) return false;
+        return occupied[index(x, y, z)];
+    }
+
+    void set(int x, int y, int z, bool value) {
+        std::uint8_t& v = occupied[index(x, y, z)];
+        if (v == value) return;
+        v = value;
+
+        // The voxel's 12 edges start at lattice points x..x+1, y..y+1, z..z+1
+        for (int k = z; k <= z + 1; k++) {
+            for (int j = y; j <= y + 1; j++) {
+                for (int i = x; i <= x + 1; i++) {
+                    chunks[chunkIndex(i / chunkSize, j / chunkSize, k / chunkSize)].dirty = true;
+                }
+            }
+        }
+        wireframe_dirty = true;
+    }
+
+    // Call after writing to occupied directly
+    void markDirty() {
+        for (Chunk& chunk : chunks) chunk.dirty = true;
+        wireframe_dirty = true;
+    }
+
+    int chunkIndex(int i, int j, int k) const { return (k * cy + j) * cx + i; }
+
+    vec4 latticePoint(int i, int j, int k) const {
+        return vec4(origin.x + i * voxelSize, origin.y + j * voxelSize,
+                    origin.z + k * voxelSize);
+    }
+
+    // Whether the lattice edge from p along axis is drawn
+    bool keepEdge(int axis, int p[3]) const {
+        // The two other axes and the four voxels around the edge
+        int b = (axis + 1) % 3, c = (axis + 2) % 3;
+        bool v[2][2];
+        for (int db = 0; db < 2; db++) {
+            for (int dc = 0; dc < 2; dc++) {
+                int q[3] = {p[0], p[1], p[2]};
+                q[b] -= 1 - db;
+                q[c] -= 1 - dc;
+                v[db][dc] = get(q[0], q[1], q[2]);
+            }
+        }
+        int count = v[0][0] + v[0][1] + v[1][0] + v[1][1];
+        return count == 1 || count == 3 || (count == 2 && v[0][0] == v[1][1]);
+    }
+
+    void extractChunk(int ci, int cj, int ck) {
+        Chunk& chunk = chunks[chunkIndex(ci, cj, ck)];
+        chunk.segments.clear();
+
+        const int n[3] = {nx, ny, nz};
+        const int lo[3] = {ci * chunkSize, cj * chunkSize, ck * chunkSize};
+        int hi[3];
+        for (int a = 0; a < 3; a++) hi[a] = std::min(lo[a] + chunkSize, n[a] + 1);
+
+        for (int axis = 0; axis < 3; axis++) {
+            int b = (axis + 1) % 3, c = (axis + 2) % 3;
+            int end = std::min(hi[axis], n[axis]);  // edges need a next point
+
+            for (int u = lo[b]; u < hi[b]; u++) {
+                for (int w = lo[c]; w < hi[c]; w++) {
+                    // Walk the line along axis, merging runs of kept edges
+                    int run_start = -1;
+                    for (int t = lo[axis]; t <= end; t++) {
+                        int p[3];
+                        p[axis] = t, p[b] = u, p[c] = w;
+                        bool keep = t < end && keepEdge(axis, p);
+
+                        if (keep && run_start < 0) run_start = t;
+                        if (!keep && run_start >= 0) {
+                            int s[3], e[3];
+                            s[axis] = run_start, s[b] = u, s[c] = w;
+                            e[axis] = t, e[b] = u, e[c] = w;
+                            chunk.segments.push_back({latticePoint(s[0], s[1], s[2]),
+                                                      latticePoint(e[0], e[1], e[2])});
+                            run_start = -1;
+                        }
+                    }
+                }
+            }
+        }
+        chunk.dirty = false;
+    }
+
+    // Re-extracts dirty chunks and rebuilds the wireframe if anything changed
+    void update() {
+        if (!wireframe_dirty) return;
+
+        for (int k = 0; k < cz; k++) {
+            for (int j = 0; j < cy; j++) {
+                for (int i = 0; i < cx; i++) {
+                    if (chunks[chunkIndex(i, j, k)].dirty) extractChunk(i, j, k);
+                }
+            }
+        }
+
+        wireframe.vertices.clear();
+        wireframe.edges.clear();
+        for (const Chunk& chunk : chunks) {
+            for (const auto& segment : chunk.segments) {
+                int first = static_cast<int>(wireframe.vertices.size());
+                wireframe.vertices.push_back(segment[0]);
+                wireframe.vertices.push_back(segment[1]);
+                wireframe.edges.push_back({first, first + 1});
+            }
+        }
+        wireframe.markDirty();
+        wireframe_dirty = false;
+    }
+
+    std::size_t segmentCount() {
+        update();
+        return wireframe.edges.size();
+    }
+
+    float calculateDistance(const Camera& camera) override {
+        update();
+        return wireframe.calculateDistance(camera);
+    }
+
+    std::unique_ptr<Shape2D> computeShape(sf::RenderWindow& window,
+                                          const Camera& camera) override {
+        update();
+        return wireframe.computeShape(window, camera);
+    }
+};
@@ -0,0 +1,309 @@
+#pragma once
+/*
+Wireframe3D / Mesh3D: indexed geometry. Every unique vertex is transformed and
+projected once per frame; edges (and triangles) refer to vertices by index.
+*/
+
+#include <SFML/Graphics.hpp>
+#include <algorithm>
+#include <array>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "3d_camera.hpp"
+#include "Frustum.hpp"
+#include "Object3D.hpp"
+#include "ProjectedVertices.hpp"
+#include "Shape2D.hpp"
+#include "math4.hpp"
+
+struct Wireframe3D;
+
+// A single edge of a Wireframe3D as its own Object3D, for when the edges
+// should be depth sorted one by one (see Wireframe3D::sortPerEdge)
+struct WireframeEdge3D : Object3D {
+    Wireframe3D* parent;
+    int edge;
+
+    WireframeEdge3D(Wireframe3D* p, int e) : parent(p), edge(e) {}
+
+    float calculateDistance(const Camera& camera) override;
+
+    std::unique_ptr<Shape2D> computeShape(sf::RenderWindow& window,
+                                          const Camera& camera) override;
+};
+
+struct Wireframe3D : Object3D {
+    std::vector<vec4> vertices;
+    std::vector<std::array<int, 2>> edges;
+    float thickness = 1.0f;
+
+    // false: the whole wireframe is one object in the collection (its edges
+    // are ordered among themselves when drawn). true: addTo adds every edge
+    // as a separate object.
+    bool sortPerEdge = false;
+
+    // Bounding sphere, used as the depth key when sorted as one object
+    vec4 center;
+    float radius = 0.0f;
+
+    // Per-view cache filled by prepare()
+    ProjectedVertices projected;
+
+    // Scratch for Instance3D: instances are drawn one after another, so each
+    // transforms into it and builds its shape before the next one runs
+    ProjectedVertices instance_scratch;
+
+    std::vector<WireframeEdge3D> edge_objects;
+
+    Wireframe3D() = default;
+    Wireframe3D(std::vector<vec4> v, std::vector<std::array<int, 2>> e,
+                float t = 1.0f)
+        : vertices(std::move(v)), edges(std::move(e)), thickness(t) {
+        updateBounds();
+    }
+
+    // From fixed-size tables, e.g. the compile-time ones in Primitives3D.hpp
+    template <std::size_t V, std::size_t E>
+    Wireframe3D(const std::array<vec4, V>& v, const std::array<std::array<int, 2>, E>& e,
+                float t = 1.0f)
+        : vertices(v.begin(), v.end()), edges(e.begin(), e.end()), thickness(t) {
+        updateBounds();
+    }
+
+    // Edge objects and collections point back at this wireframe, so it never
+    // moves: keep it where it was constructed (a member, a local, an
+    // ObjectPool3D, a std::unique_ptr...). Returning it from a function by
+    // value still works through guaranteed copy elision.
+    Wireframe3D(const Wireframe3D&) = delete;
+    Wireframe3D& operator=(const Wireframe3D&) = delete;
+    Wireframe3D(Wireframe3D&&) = delete;
+    Wireframe3D& operator=(Wireframe3D&&) = delete;
+
+    // Call after changing vertices
+    void markDirty() {
+        updateBounds();
+        projected.invalidate();
+    }
+
+    void updateBounds() {
+        center = vec4();
+        radius = 0.0f;
+        if (vertices.empty()) return;
+
+        for (vec4& v : vertices) center += v;
+        center /= static_cast<float>(vertices.size());
+        for (vec4& v : vertices) {
+            radius = std::max(radius, (v - center).magnitude());
+        }
+    }
+
+    // Adds this wireframe to a collection (e.g. collection.c), either as one
+    // object or as one object per edge depending on sortPerEdge. The entries
+    // point into this object, which must outlive them.
+    void addTo(std::vector<std::pair<int, Object3D*>>& objects, int id) {
+        if (!sortPerEdge) {
+            objects.push_back({id, this});
+            return;
+        }
+
+        edge_objects.clear();
+        for (int e = 0; e < static_cast<int>(edges.size()); e++) {
+            edge_objects.emplace_back(this, e);
+        }
+        for (auto& edge : edge_objects) objects.push_back({id, &edge});
+    }
+
+    static sf::Vector2f project(sf::RenderWindow& window, const Camera& camera,
+                                vec4 view_point) {
+        return ProjectedVertices::project(window, camera, view_point);
+    }
+
+    // Transforms and projects every vertex once; does nothing if the view
+    // hasn't changed since the last call
+    void prepare(sf::RenderWindow& window, const Camera& camera) {
+        projected.update(vertices, window, camera, thickness);
+    }
+
+    // Transforms with any model-view matrix into a separate cache (instances
+    // use instance_scratch, so the model's cache is left alone)
+    void transformVertices(ProjectedVertices& out, mat4 modelview,
+                           sf::RenderWindow& window, const Camera& camera) const {
+        out.transform(vertices.data(), vertices.size(), modelview, window, camera,
+                      thickness);
+    }
+
+    // Screen-space endpoints of an edge, from a filled cache (projected after
+    // prepare, or an instance's)
+    bool edgeOnScreen(int e, const ProjectedVertices& p, const Frustum& frustum,
+                      sf::RenderWindow& window, const Camera& camera,
+                      sf::Vector2f& a_, sf::Vector2f& b_) const {
+        return p.segment(edges[e][0], edges[e][1], frustum, window, camera, a_, b_);
+    }
+
+    // Appends all visible edges, farthest first
+    void appendEdges(Triangles2D& shape, const ProjectedVertices& p,
+                     sf::RenderWindow& window, const Camera& camera,
+                     sf::Color color = sf::Color::White) const {
+        Frustum frustum(window, camera, NEAR, FAR_PLANE, thickness);
+
+        std::vector<std::pair<float, int>> order;
+        order.reserve(edges.size());
+        for (int e = 0; e < static_cast<int>(edges.size()); e++) {
+            vec4 mid = p.view[edges[e][0]];
+            mid += p.view[edges[e][1]];
+            order.push_back({mid.magnitudeSquared(), e});
+        }
+        std::sort(order.begin(), order.end(),
+                  [](const auto& a, const auto& b) { return a.first > b.first; });
+
+        for (const auto& [key, e] : order) {
+            sf::Vector2f a_, b_;
+            if (edgeOnScreen(e, p, frustum, window, camera, a_, b_)) {
+                appendLine(shape.vertices, a_, b_, thickness, color);
+            }
+        }
+    }
+
+    // Appends everything this object draws, using the contents of the view
+    // cache p (vertex colors are multiplied by tint)
+    virtual void appendTo(Triangles2D& shape, const ProjectedVertices& p,
+                          sf::RenderWindow& window, const Camera& camera,
+                          sf::Color tint = sf::Color::White) const {
+        appendEdges(shape, p, window, camera, tint);
+    }
+
+    float calculateDistance(const Camera& camera) override {
+        return (camera.cf.get_position() - center).magnitude();
+    }
+
+    std::unique_ptr<Shape2D> computeShape(sf::RenderWindow& window,
+                                          const Camera& camera) override {
+        prepare(window, camera);
+
+        auto shape = std::make_unique<Triangles2D>();
+        appendTo(*shape, projected, window, camera);
+
+        if (shape->vertices.getVertexCount() == 0) return nullptr;
+        return shape;
+    }
+};
+
+inline float WireframeEdge3D::calculateDistance(const Camera& camera) {
+    const auto& e = parent->edges[edge];
+    return std::sqrt(Line3D::segmentDistanceSquared(
+        camera.cf.get_position(), parent->vertices[e[0]],
+        parent->vertices[e[1]]));
+}
+
+inline std::unique_ptr<Shape2D> WireframeEdge3D::computeShape(
+    sf::RenderWindow& window, const Camera& camera) {
+    parent->prepare(window, camera);
+
+    Frustum frustum(window, camera, NEAR, FAR_PLANE, parent->thickness);
+    sf::Vector2f a_, b_;
+    if (!parent->edgeOnScreen(edge, parent->projected, frustum, window, camera, a_, b_))
+        return nullptr;
+
+    return std::make_unique<Line2D>(a_, b_, parent->thickness);
+}
+
+// Indexed triangle mesh. Faces are filled with fillColor (times the draw
+// color), sorted back to front and clipped at the near plane; the unique
+// triangle edges are drawn on top as a wireframe.
+// Faces are only drawn when the mesh is sorted as a single object.
+struct Mesh3D : Wireframe3D {
+    std::vector<std::array<int, 3>> triangles;
+    sf::Color fillColor = sf::Color(128, 128, 128);
+    bool drawFaces = true;
+    bool drawEdges = true;
+
+    Mesh3D() = default;
+    Mesh3D(std::vector<vec4> v, std::vector<std::array<int, 3>> t,
+           float thickness = 1.0f)
+        : Wireframe3D(std::move(v), {}, thickness), triangles(std::move(t)) {
+        buildEdges();
+    }
+
+    // Derives the (unique) edge list from the triangles
+    void buildEdges() {
+        edges.clear();
+        for (const auto& t : triangles) {
+            for (int k = 0; k < 3; k++) {
+                int i = t[k], j = t[(k + 1) % 3];
+                edges.push_back({std::min(i, j), std::max(i, j)});
+            }
+        }
+        std::sort(edges.begin(), edges.end());
+        edges.erase(std::unique(edges.begin(), edges.end()), edges.end());
+    }
+
+    // Clips a view-space polygon to the near plane (Sutherland–Hodgman)
+    static int clipNear(const vec4* in, int n, vec4* out) {
+        int count = 0;
+        for (int k = 0; k < n; k++) {
+            vec4 a = in[k], b = in[(k + 1) % n];
+            bool a_in = a.z >= NEAR, b_in = b.z >= NEAR;
+
+            if (a_in) out[count++] = a;
+            if (a_in != b_in) {
+                float t = (NEAR - a.z) / (b.z - a.z);
+                out[count++] = a + (b - a) * t;
+            }
+        }
+        return count;
+    }
+
+    void appendFaces(Triangles2D& shape, const ProjectedVertices& p,
+                     sf::RenderWindow& window, const Camera& camera,
+                     sf::Color tint = sf::Color::White) const {
+        const sf::Color color = fillColor * tint;
+        const auto& view = p.view;
+        const auto& screen = p.screen;
+        const auto& in_front = p.in_front;
+
+        std::vector<std::pair<float, int>> order;
+        order.reserve(triangles.size());
+        for (int t = 0; t < static_cast<int>(triangles.size()); t++) {
+            const auto& tri = triangles[t];
+            if (!in_front[tri[0]] && !in_front[tri[1]] && !in_front[tri[2]])
+                continue;
+
+            vec4 centroid = view[tri[0]];
+            centroid += view[tri[1]];
+            centroid += view[tri[2]];
+            order.push_back({centroid.magnitudeSquared(), t});
+        }
+        std::sort(order.begin(), order.end(),
+                  [](const auto& a, const auto& b) { return a.first > b.first; });
+
+        for (const auto& [key, t] : order) {
+            const auto& tri = triangles[t];
+
+            if (in_front[tri[0]] && in_front[tri[1]] && in_front[tri[2]]) {
+                for (int k = 0; k < 3; k++) {
+                    shape.vertices.append({screen[tri[k]], color});
+                }
+                continue;
+            }
+
+            vec4 in[3] = {view[tri[0]], view[tri[1]], view[tri[2]]};
+            vec4 clipped[4];
+            int count = clipNear(in, 3, clipped);
+
+            for (int k = 1; k + 1 < count; k++) {
+                shape.vertices.append({project(window, camera, clipped[0]), color});
+                shape.vertices.append({project(window, camera, clipped[k]), color});
+                shape.vertices.append({project(window, camera, clipped[k + 1]), color});
+            }
+        }
+    }
+
+    void appendTo(Triangles2D& shape, const ProjectedVertices& p,
+                  sf::RenderWindow& window, const Camera& camera,
+                  sf::Color tint = sf::Color::White) const override {
+        if (drawFaces) appendFaces(shape, p, window, camera, tint);
+        if (drawEdges) appendEdges(shape, p, window, camera, tint);
+    }
+};
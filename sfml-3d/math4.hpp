@@ -23,6 +23,14 @@ struct vec4 {
         return sqrt(x*x+ y*y+z*z);
     }
 
+    float magnitudeSquared() const {
+        return x*x + y*y + z*z;
+    }
+
+    float dot(const vec4& b) const {
+        return x*b.x + y*b.y + z*b.z;
+    }
+
     std::string string() const {
         return "(" + std::to_string(x) + " " + std::to_string(y) + " " + std::to_string(z)  + ")";
     }
@@ -278,3 +286,36 @@ struct alignas(16) mat4 {
 inline bool operator==(const vec4& a, const vec4& b) {
     return a.x == b.x && a.y == b.y && a.z == b.z;
 }
+
+
+// Compile-time versions of sqrt, sin and cos (std:: ones are not constexpr
+// in C++17), for tables generated at compile time
+constexpr double CONST_PI = 3.14159265358979323846;
+
+constexpr double constSqrt(double x) {
+    if (x <= 0.0) return 0.0;
+    double r = x < 1.0 ? 1.0 : x;
+    for (int i = 0; i < 64; i++) {
+        double next = 0.5 * (r + x / r);
+        if (next == r) break;
+        r = next;
+    }
+    return r;
+}
+
+// Taylor series after reducing x to [-pi, pi]
+constexpr double constSin(double x) {
+    double turns = x / (2.0 * CONST_PI);
+    x -= 2.0 * CONST_PI * static_cast<double>(static_cast<long long>(turns));
+    if (x > CONST_PI) x -= 2.0 * CONST_PI;
+    if (x < -CONST_PI) x += 2.0 * CONST_PI;
+
+    double term = x, sum = x;
+    for (int n = 1; n < 20; n++) {
+        term *= -x * x / ((2 * n) * (2 * n + 1));
+        sum += term;
+    }
+    return sum;
+}
+
+constexpr double constCos(double x) { return constSin(x + CONST_PI / 2.0); }
@@ -2,6 +2,9 @@
 
 #pragma once
 #include <SFML/Graphics.hpp>
+#include <algorithm>
+#include <cmath>
+#include <vector>
 
 
 void drawLine(
@@ -69,4 +72,245 @@ float dot(const sf::Vector2f& a, const sf::Vector2f& b)
 
 sf::Vector2f perpendicular(sf::Vector2f a) {
     return sf::Vector2f(a.y, -a.x);
-}
\ No newline at end of file
+}
+
+
+// Same quad as drawLine, but appended to a Triangles vertex array so many
+// lines can be drawn with a single draw call
+void appendLine(
+    sf::VertexArray& vertices,
+    sf::Vector2f a,
+    sf::Vector2f b,
+    float thickness = 1.0f,
+    sf::Color color = sf::Color::White
+)
+{
+    sf::Vector2f direction = b - a;
+    float length = magnitude(direction);
+    if (length == 0.f) return;
+
+    sf::Vector2f offset = perpendicular(direction) * (thickness / 2.f / length);
+
+    sf::Vector2f p0 = a + offset, p1 = b + offset;
+    sf::Vector2f p2 = b - offset, p3 = a - offset;
+
+    vertices.append({p0, color});
+    vertices.append({p1, color});
+    vertices.append({p2, color});
+    vertices.append({p0, color});
+    vertices.append({p2, color});
+    vertices.append({p3, color});
+}
+
+
+// Square of the given size centered on p, as two triangles
+void appendPoint(
+    sf::VertexArray& vertices,
+    sf::Vector2f p,
+    float size = 1.0f,
+    sf::Color color = sf::Color::White
+)
+{
+    float h = size / 2.f;
+    sf::Vector2f p0(p.x - h, p.y - h), p1(p.x + h, p.y - h);
+    sf::Vector2f p2(p.x + h, p.y + h), p3(p.x - h, p.y + h);
+
+    vertices.append({p0, color});
+    vertices.append({p1, color});
+    vertices.append({p2, color});
+    vertices.append({p0, color});
+    vertices.append({p2, color});
+    vertices.append({p3, color});
+}
+
+
+// Rectangle of half extent half centered on p, textured with the given
+// sub-rectangle of a texture (in pixels), as two triangles
+void appendSprite(
+    sf::VertexArray& vertices,
+    sf::Vector2f p,
+    sf::Vector2f half,
+    sf::IntRect rect,
+    sf::Color color = sf::Color::White
+)
+{
+    float u0 = static_cast<float>(rect.position.x), v0 = static_cast<float>(rect.position.y);
+    float u1 = u0 + rect.size.x, v1 = v0 + rect.size.y;
+
+    sf::Vector2f p0(p.x - half.x, p.y - half.y), p1(p.x + half.x, p.y - half.y);
+    sf::Vector2f p2(p.x + half.x, p.y + half.y), p3(p.x - half.x, p.y + half.y);
+
+    vertices.append({p0, color, {u0, v0}});
+    vertices.append({p1, color, {u1, v0}});
+    vertices.append({p2, color, {u1, v1}});
+    vertices.append({p0, color, {u0, v0}});
+    vertices.append({p2, color, {u1, v1}});
+    vertices.append({p3, color, {u0, v1}});
+}
+
+// Same quad written over vertices [at, at + 6), for arrays sized up front
+void appendSprite(
+    sf::VertexArray& vertices,
+    std::size_t at,
+    sf::Vector2f p,
+    sf::Vector2f half,
+    sf::IntRect rect,
+    sf::Color color = sf::Color::White
+)
+{
+    float u0 = static_cast<float>(rect.position.x), v0 = static_cast<float>(rect.position.y);
+    float u1 = u0 + rect.size.x, v1 = v0 + rect.size.y;
+
+    sf::Vector2f p0(p.x - half.x, p.y - half.y), p1(p.x + half.x, p.y - half.y);
+    sf::Vector2f p2(p.x + half.x, p.y + half.y), p3(p.x - half.x, p.y + half.y);
+
+    vertices[at] = {p0, color, {u0, v0}};
+    vertices[at + 1] = {p1, color, {u1, v0}};
+    vertices[at + 2] = {p2, color, {u1, v1}};
+    vertices[at + 3] = {p0, color, {u0, v0}};
+    vertices[at + 4] = {p2, color, {u1, v1}};
+    vertices[at + 5] = {p3, color, {u0, v1}};
+}
+
+
+// Point counts of the precomputed unit circles used by appendCircle
+const int CIRCLE_LOD_COUNTS[] = {6, 8, 12, 16, 24, 32, 48, 64, 96, 128};
+const int CIRCLE_LOD_LEVELS = sizeof(CIRCLE_LOD_COUNTS) / sizeof(CIRCLE_LOD_COUNTS[0]);
+
+
+// Unit circle with CIRCLE_LOD_COUNTS[level] points, computed on first use
+const std::vector<sf::Vector2f>& unitCircle(int level)
+{
+    static const std::vector<std::vector<sf::Vector2f>> tables = [] {
+        std::vector<std::vector<sf::Vector2f>> t(CIRCLE_LOD_LEVELS);
+        for (int level = 0; level < CIRCLE_LOD_LEVELS; level++) {
+            int n = CIRCLE_LOD_COUNTS[level];
+            for (int i = 0; i < n; i++) {
+                float angle = 2.f * 3.14159265f * i / n;
+                t[level].push_back({std::cos(angle), std::sin(angle)});
+            }
+        }
+        return t;
+    }();
+    return tables[level];
+}
+
+
+// Smallest level with at least pointCount points. With pointCount = 0 the
+// count is picked from the radius so the outline stays within a quarter
+// pixel of the true circle.
+int circleLevel(float radius, int pointCount = 0)
+{
+    if (pointCount <= 0) {
+        float ratio = 1.f - 0.25f / std::max(radius, 0.125f);
+        pointCount = static_cast<int>(std::ceil(3.14159265f / std::acos(ratio)));
+    }
+    for (int level = 0; level < CIRCLE_LOD_LEVELS; level++) {
+        if (CIRCLE_LOD_COUNTS[level] >= pointCount) return level;
+    }
+    return CIRCLE_LOD_LEVELS - 1;
+}
+
+
+// Filled circle as a fan of triangles from a precomputed unit circle. With
+// pointCount = 0 the detail follows the radius, and circles under 1.5 pixels
+// become a single quad.
+void appendCircle(
+    sf::VertexArray& vertices,
+    sf::Vector2f center,
+    float radius,
+    sf::Color color = sf::Color::White,
+    int pointCount = 0
+)
+{
+    if (pointCount <= 0 && radius < 1.5f) {
+        appendPoint(vertices, center, std::max(2.f * radius, 1.f), color);
+        return;
+    }
+
+    const std::vector<sf::Vector2f>& unit = unitCircle(circleLevel(radius, pointCount));
+    sf::Vector2f prev = center + unit.back() * radius;
+
+    for (const sf::Vector2f& u : unit) {
+        sf::Vector2f next = center + u * radius;
+        vertices.append({center, color});
+        vertices.append({prev, color});
+        vertices.append({next, color});
+        prev = next;
+    }
+}
+
+
+// Connected line through count points, as a triangle strip written out as
+// Triangles. Interior points get mitered joins (clamped to miterLimit times
+// half the thickness) so consecutive segments meet without gaps or overlaps.
+// colors, if given, holds one color per point.
+void appendPolyline(
+    sf::VertexArray& vertices,
+    const sf::Vector2f* points,
+    std::size_t count,
+    float thickness = 1.0f,
+    sf::Color color = sf::Color::White,
+    const sf::Color* colors = nullptr,
+    float miterLimit = 4.0f
+)
+{
+    if (count < 2) return;
+    const float h = thickness / 2.f;
+
+    // Unit direction from points[i] to the next point that differs from it
+    auto nextDirection = [&](std::size_t i, sf::Vector2f& direction) {
+        for (std::size_t j = i + 1; j < count; j++) {
+            sf::Vector2f d = points[j] - points[i];
+            float length = magnitude(d);
+            if (length > 0.f) {
+                direction = d / length;
+                return true;
+            }
+        }
+        return false;
+    };
+
+    sf::Vector2f direction;
+    if (!nextDirection(0, direction)) return;
+
+    sf::Vector2f a = points[0];
+    sf::Vector2f offset_a = perpendicular(direction) * h;
+    sf::Color color_a = colors ? colors[0] : color;
+
+    for (std::size_t i = 1; i < count; i++) {
+        if (points[i] == a) continue;
+
+        sf::Vector2f b = points[i];
+        sf::Vector2f normal = perpendicular(direction) * h;
+        sf::Vector2f offset_b = normal;
+
+        sf::Vector2f next;
+        bool has_next = nextDirection(i, next);
+        if (has_next) {
+            sf::Vector2f miter = perpendicular(direction) + perpendicular(next);
+            float length = magnitude(miter);
+
+            // Nearly reversing paths keep the plain normal
+            if (length > 1e-3f) {
+                miter = miter / length;
+                float scale = h / std::max(dot(miter, perpendicular(direction)), 1.f / miterLimit);
+                offset_b = miter * scale;
+            }
+        }
+
+        sf::Color color_b = colors ? colors[i] : color;
+
+        vertices.append({a + offset_a, color_a});
+        vertices.append({b + offset_b, color_b});
+        vertices.append({b - offset_b, color_b});
+        vertices.append({a + offset_a, color_a});
+        vertices.append({b - offset_b, color_b});
+        vertices.append({a - offset_a, color_a});
+
+        a = b;
+        offset_a = offset_b;
+        color_a = color_b;
+        if (has_next) direction = next;
+    }
+}
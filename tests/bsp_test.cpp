@@ -0,0 +1,126 @@
+/*
+BSPTree3D: the traversal order is checked against a brute-force occlusion
+test. Every pair of line pieces that overlap on screen is projected, and the
+one nearer to the eye where they cross must be drawn later.
+
+Leaves hold one object and the depth limit is out of reach, so the order
+must be exact (objects sharing a leaf are only ordered by distance).
+*/
+
+#undef NDEBUG  // checks stay on in release builds
+#include <cassert>
+#include <cmath>
+#include <iostream>
+#include <map>
+#include <random>
+#include <vector>
+#include <SFML/Graphics.hpp>
+#include <sfml-3d/3d_engine.hpp>
+
+// Parameters u, t in (0, 1) where 2D segments p0-p1 and q0-q1 cross
+bool crossing(sf::Vector2f p0, sf::Vector2f p1, sf::Vector2f q0, sf::Vector2f q1,
+              float& u, float& t) {
+    sf::Vector2f r = p1 - p0, s = q1 - q0, d = q0 - p0;
+    float denom = r.x * s.y - r.y * s.x;
+    if (std::abs(denom) < 1e-9f) return false;
+    u = (d.x * s.y - d.y * s.x) / denom;
+    t = (d.x * r.y - d.y * r.x) / denom;
+    const float eps = 1e-3f;
+    return u > eps && u < 1 - eps && t > eps && t < 1 - eps;
+}
+
+// View-space depth at parameter u of the projected segment a-b
+// (1/z is linear on screen)
+float depthAt(const vec4& a, const vec4& b, float u) {
+    return 1.0f / ((1.0f - u) / a.z + u / b.z);
+}
+
+int main() {
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<float> coord(-50.0f, 50.0f);
+    std::uniform_real_distribution<float> offset(-15.0f, 15.0f);
+
+    std::vector<Line3D> lines;
+    std::vector<Sphere3D> spheres;
+    lines.reserve(300);
+    for (int i = 0; i < 300; i++) {
+        vec4 a(coord(rng), coord(rng), coord(rng));
+        lines.emplace_back(a, a + vec4(offset(rng), offset(rng), offset(rng)));
+    }
+    for (int i = 0; i < 40; i++) {
+        spheres.emplace_back(vec4(coord(rng), coord(rng), coord(rng)), 1.0f);
+    }
+
+    std::vector<BSPTree3D::Entry> entries;
+    for (std::size_t i = 0; i < lines.size(); i++) {
+        entries.push_back({static_cast<int>(i), &lines[i]});
+    }
+    for (std::size_t i = 0; i < spheres.size(); i++) {
+        entries.push_back({static_cast<int>(lines.size() + i), &spheres[i]});
+    }
+
+    BSPTree3D tree;
+    tree.maxLeafSize = 1;
+    tree.maxDepth = 64;
+    tree.build(entries);
+
+    sf::RenderWindow window;
+    Camera camera(window);
+    std::uniform_real_distribution<float> eye_xy(-60.0f, 60.0f);
+    std::uniform_real_distribution<float> eye_z(-200.0f, 0.0f);
+
+    for (int view = 0; view < 20; view++) {
+        camera.cf = mat4::translation(eye_xy(rng), eye_xy(rng), eye_z(rng));
+        std::vector<BSPTree3D::Entry> out;
+        tree.traverse(camera, out);
+
+        // Every sphere once, and the pieces of every line add up to it
+        std::map<int, int> seen;
+        std::map<int, float> length;
+        for (const auto& [id, obj] : out) {
+            seen[id]++;
+            if (auto* line = dynamic_cast<Line3D*>(obj)) {
+                length[id] += (line->b - line->a).magnitude();
+            }
+        }
+        for (std::size_t i = 0; i < lines.size(); i++) {
+            float full = (lines[i].b - lines[i].a).magnitude();
+            assert(std::abs(length[static_cast<int>(i)] - full) < 1e-3f * full);
+        }
+        for (std::size_t i = 0; i < spheres.size(); i++) {
+            assert(seen[static_cast<int>(lines.size() + i)] == 1);
+        }
+
+        // Line pieces in drawing order, in view space
+        mat4 inv = camera.cf.inverse_rigid();
+        std::vector<std::pair<vec4, vec4>> pieces;
+        for (const auto& entry : out) {
+            if (auto* line = dynamic_cast<Line3D*>(entry.second)) {
+                pieces.push_back({inv * line->a, inv * line->b});
+            }
+        }
+
+        int overlaps = 0;
+        for (std::size_t i = 0; i < pieces.size(); i++) {
+            for (std::size_t j = i + 1; j < pieces.size(); j++) {
+                const auto& [a0, a1] = pieces[i];
+                const auto& [b0, b1] = pieces[j];
+                if (std::min({a0.z, a1.z, b0.z, b1.z}) < 1.0f) continue;
+
+                float u, t;
+                sf::Vector2f pa0(a0.x / a0.z, a0.y / a0.z), pa1(a1.x / a1.z, a1.y / a1.z);
+                sf::Vector2f pb0(b0.x / b0.z, b0.y / b0.z), pb1(b1.x / b1.z, b1.y / b1.z);
+                if (!crossing(pa0, pa1, pb0, pb1, u, t)) continue;
+
+                // Drawn first, so it must be the farther one where they cross
+                overlaps++;
+                assert(depthAt(a0, a1, u) >= depthAt(b0, b1, t) - 1e-3f);
+            }
+        }
+        assert(overlaps > 0);
+    }
+
+    std::cout << "bsp_test passed (" << tree.nodes.size() << " nodes, "
+              << tree.fragments.size() << " fragments)\n";
+    return 0;
+}
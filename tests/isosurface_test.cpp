@@ -0,0 +1,84 @@
+/*
+Isosurface3D: surface nets on a sampled sphere give a closed surface
+(every edge shared by two triangles, Euler characteristic 2) whose vertices
+lie within a cell of the true radius, and re-extracting only dirty chunks
+gives the same mesh as extracting everything.
+*/
+
+#undef NDEBUG  // checks stay on in release builds
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cmath>
+#include <iostream>
+#include <map>
+#include <tuple>
+#include <vector>
+#include <SFML/Graphics.hpp>
+#include <sfml-3d/3d_engine.hpp>
+
+// Squared distance from the grid center, in coordinates relative to origin
+float sphereField(float x, float y, float z) {
+    x -= 32, y -= 32, z -= 32;
+    return x * x + y * y + z * z;
+}
+
+// Bump that only changes samples near x = 8
+float bumpedField(float x, float y, float z) {
+    float bump = std::max(0.0f, 6.0f - std::abs(x - 8.0f)) * 40.0f;
+    return sphereField(x, y, z) - bump;
+}
+
+void checkClosed(const Mesh3D& mesh) {
+    std::map<std::pair<int, int>, int> uses;
+    for (const auto& t : mesh.triangles) {
+        for (int k = 0; k < 3; k++) {
+            int a = t[k], b = t[(k + 1) % 3];
+            uses[{std::min(a, b), std::max(a, b)}]++;
+        }
+    }
+    for (const auto& [edge, count] : uses) assert(count == 2);
+
+    long v = static_cast<long>(mesh.vertices.size());
+    long e = static_cast<long>(uses.size());
+    long f = static_cast<long>(mesh.triangles.size());
+    assert(v - e + f == 2);
+}
+
+std::vector<std::tuple<float, float, float>> sortedVertices(const Mesh3D& mesh) {
+    std::vector<std::tuple<float, float, float>> out;
+    for (const vec4& p : mesh.vertices) out.emplace_back(p.x, p.y, p.z);
+    std::sort(out.begin(), out.end());
+    return out;
+}
+
+int main() {
+    Isosurface3D iso(64, 64, 64, vec4(-32, -32, -32), 1.0f);
+    iso.sample(sphereField);
+    iso.setIsoValue(400.0f);
+    iso.update();
+
+    assert(!iso.mesh.vertices.empty());
+    checkClosed(iso.mesh);
+    for (const vec4& p : iso.mesh.vertices) {
+        vec4 v = p;
+        assert(std::abs(v.magnitude() - 20.0f) < 1.0f);  // centered on the world origin
+    }
+
+    // Changing a slab only re-extracts the chunks around it
+    auto before = sortedVertices(iso.mesh);
+    iso.sample(bumpedField, 0, 0, 0, 20, 63, 63);
+    iso.update();
+    checkClosed(iso.mesh);
+    assert(sortedVertices(iso.mesh) != before);
+
+    Isosurface3D fresh(64, 64, 64, vec4(-32, -32, -32), 1.0f);
+    fresh.sample(bumpedField);
+    fresh.setIsoValue(400.0f);
+    fresh.update();
+    assert(iso.mesh.triangles.size() == fresh.mesh.triangles.size());
+    assert(sortedVertices(iso.mesh) == sortedVertices(fresh.mesh));
+
+    std::cout << "isosurface_test passed (" << iso.mesh.vertices.size() << " vertices)\n";
+    return 0;
+}
@@ -0,0 +1,85 @@
+/*
+PointCloud3D: after build() every octree node covers a contiguous range of
+points that lie inside its cube, children split their parent's range in
+octant order, and colors are reordered along with the points.
+*/
+
+#undef NDEBUG  // checks stay on in release builds
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <vector>
+#include <SFML/Graphics.hpp>
+#include <sfml-3d/3d_engine.hpp>
+
+// Color that encodes a point's position, to follow it through the reorder
+sf::Color tag(const vec4& p) {
+    return sf::Color(static_cast<std::uint8_t>(static_cast<int>(p.x) & 255),
+                     static_cast<std::uint8_t>(static_cast<int>(p.y) & 255),
+                     static_cast<std::uint8_t>(static_cast<int>(p.z) & 255));
+}
+
+int main() {
+    std::mt19937 rng(3);
+    std::uniform_real_distribution<float> coord(0.0f, 200.0f);
+
+    std::vector<vec4> points;
+    std::vector<sf::Color> colors;
+    for (int i = 0; i < 50000; i++) {
+        points.push_back(vec4(coord(rng), coord(rng), coord(rng)));
+        colors.push_back(tag(points.back()));
+    }
+
+    PointCloud3D cloud;
+    cloud.leafSize = 64;
+    cloud.points = points;
+    cloud.colors = colors;
+    cloud.build();
+
+    assert(cloud.points.size() == points.size());
+    assert(!cloud.nodes.empty());
+    assert(cloud.nodes[0].begin == 0);
+    assert(cloud.nodes[0].end == static_cast<int>(points.size()));
+
+    for (std::size_t i = 0; i < cloud.points.size(); i++) {
+        sf::Color c = tag(cloud.points[i]);
+        assert(cloud.colors[i] == c);
+    }
+
+    const float eps = 1e-3f;
+    for (const auto& node : cloud.nodes) {
+        for (int i = node.begin; i < node.end; i++) {
+            const vec4& p = cloud.points[i];
+            assert(std::abs(p.x - node.center.x) <= node.half + eps);
+            assert(std::abs(p.y - node.center.y) <= node.half + eps);
+            assert(std::abs(p.z - node.center.z) <= node.half + eps);
+        }
+
+        // Children tile the parent's range in octant order
+        int next = node.begin;
+        bool leaf = true;
+        for (int o = 0; o < 8; o++) {
+            int c = node.children[o];
+            if (c < 0) continue;
+            leaf = false;
+            const auto& child = cloud.nodes[c];
+            assert(child.begin == next);
+            assert(child.end > child.begin);
+            assert(std::abs(child.half - node.half / 2.0f) < eps);
+            for (int i = child.begin; i < child.end; i++) {
+                assert(octantOf(cloud.points[i], node.center) == o);
+            }
+            next = child.end;
+        }
+        if (leaf) {
+            assert(node.end - node.begin <= cloud.leafSize);
+        } else {
+            assert(next == node.end);
+        }
+    }
+
+    std::cout << "pointcloud_test passed (" << cloud.nodes.size() << " nodes)\n";
+    return 0;
+}
@@ -0,0 +1,72 @@
+/*
+Polyline3D: chains of lines are joined into paths, chunks cover every
+segment once, and screen-space simplification drops collinear vertices but
+keeps the ones chunks and clipping rely on.
+*/
+
+#undef NDEBUG  // checks stay on in release builds
+#include <cassert>
+#include <iostream>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include <SFML/Graphics.hpp>
+#include <sfml-3d/3d_engine.hpp>
+
+// Chunks point back at the polyline, so it must stay put
+static_assert(!std::is_copy_constructible_v<Polyline3D>);
+static_assert(!std::is_move_constructible_v<Polyline3D>);
+
+int main() {
+    // Two chains: a-b-c-d and e-f
+    vec4 a(0, 0, 10), b(1, 0, 10), c(2, 1, 10), d(3, 1, 11), e(9, 9, 9), f(9, 8, 9);
+    Line3D ab(a, b, 2.0f), bc(b, c), cd(c, d), ef(e, f, 3.0f);
+    auto paths = Polyline3D::fromLines({&ab, &bc, &cd, &ef});
+    assert(paths.size() == 2);
+    assert(paths[0]->vertices.size() == 4);
+    assert(paths[0]->vertices[3] == d);
+    assert(paths[0]->thickness == 2.0f);
+    assert(paths[1]->vertices.size() == 2);
+    assert(paths[1]->thickness == 3.0f);
+
+    // 999 segments along x in front of the camera
+    std::vector<vec4> straight;
+    for (int i = 0; i < 1000; i++) straight.push_back(vec4(i * 0.1f - 50.0f, 0.0f, 100.0f));
+    Polyline3D line(straight);
+    line.chunkSize = 64;
+
+    std::vector<std::pair<int, Object3D*>> objects;
+    line.addTo(objects, 7);
+    assert(objects.size() == line.chunks.size());
+    int next = 0;
+    for (const auto& chunk : line.chunks) {
+        assert(chunk.parent == &line);
+        assert(chunk.begin == next && chunk.end > chunk.begin);
+        next = chunk.end;
+    }
+    assert(next == line.segmentCount());
+
+    sf::RenderWindow window;
+    Camera camera(window);
+    camera.cf = mat4::identity();
+
+    line.simplifyTolerance = 0.5f;
+    line.prepare(window, camera);
+    for (std::size_t k = 0; k < line.kept.size(); k++) {
+        int v = line.kept[k];
+        bool end = v == 0 || v == 999;
+        assert(end || v % line.chunkSize == 0);  // nothing else bends the path
+    }
+    assert(line.kept.size() == static_cast<std::size_t>(2 + 999 / line.chunkSize));
+
+    // A different tolerance or a turn in place invalidates the result
+    assert(!line.needsSimplify(window, camera));
+    line.simplifyTolerance = 1.0f;
+    assert(line.needsSimplify(window, camera));
+    line.prepare(window, camera);
+    camera.cf = camera.cf * mat4::rotation_y(0.5f);
+    assert(line.needsSimplify(window, camera));
+
+    std::cout << "polyline_test passed\n";
+    return 0;
+}
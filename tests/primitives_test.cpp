@@ -0,0 +1,94 @@
+/*
+Primitives3D: table sizes are checked at compile time; the generated
+geometry (unit vertices, valid and distinct edges, icosphere valences) at
+run time.
+*/
+
+#undef NDEBUG  // checks stay on in release builds
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cmath>
+#include <iostream>
+#include <vector>
+#include <SFML/Graphics.hpp>
+#include <sfml-3d/3d_engine.hpp>
+
+constexpr auto ICO0 = icosphereWireframe<0>();
+constexpr auto ICO1 = icosphereWireframe<1>();
+constexpr auto ICO2 = icosphereWireframe<2>();
+constexpr auto CYLINDER = cylinderWireframe<12>();
+constexpr auto CONE = coneWireframe<10>();
+constexpr auto GRID = gridWireframe<4, 3>();
+constexpr auto TORUS = torusWireframe<16, 8>();
+constexpr auto GIZMO = axisGizmoWireframe();
+
+// 10 * 4^N + 2 vertices, 30 * 4^N edges, 20 * 4^N faces
+static_assert(ICO0.vertices.size() == 12 && ICO0.edges.size() == 30);
+static_assert(ICO1.vertices.size() == 42 && ICO1.edges.size() == 120);
+static_assert(ICO2.vertices.size() == 162 && ICO2.edges.size() == 480);
+static_assert(Icosphere<2>::F == 320);
+static_assert(CYLINDER.vertices.size() == 24 && CYLINDER.edges.size() == 36);
+static_assert(CONE.vertices.size() == 11 && CONE.edges.size() == 20);
+static_assert(GRID.vertices.size() == 2 * 5 + 2 * 4 && GRID.edges.size() == 5 + 4);
+static_assert(TORUS.vertices.size() == 128 && TORUS.edges.size() == 256);
+static_assert(GIZMO.vertices.size() == 10 && GIZMO.edges.size() == 9);
+
+// Evaluated by the compiler, not at startup
+static_assert(ICO0.vertices[0].y > 0.0f);
+static_assert(CONE.vertices[10].y == 1.0f);
+
+// Edges in range, no loops, no duplicates
+template <typename Table>
+void checkEdges(const Table& table) {
+    const int n = static_cast<int>(table.vertices.size());
+    std::vector<std::pair<int, int>> seen;
+    for (const auto& e : table.edges) {
+        assert(e[0] >= 0 && e[0] < n && e[1] >= 0 && e[1] < n && e[0] != e[1]);
+        seen.push_back({std::min(e[0], e[1]), std::max(e[0], e[1])});
+    }
+    std::sort(seen.begin(), seen.end());
+    assert(std::adjacent_find(seen.begin(), seen.end()) == seen.end());
+}
+
+template <typename Table>
+void checkIcosphere(const Table& table) {
+    checkEdges(table);
+    std::vector<int> valence(table.vertices.size(), 0);
+    for (const auto& e : table.edges) valence[e[0]]++, valence[e[1]]++;
+
+    // The 12 original corners keep 5 neighbours, every added vertex has 6
+    for (std::size_t i = 0; i < table.vertices.size(); i++) {
+        vec4 v = table.vertices[i];
+        assert(std::abs(v.magnitude() - 1.0f) < 1e-5f);
+        assert(valence[i] == (i < 12 ? 5 : 6));
+    }
+}
+
+int main() {
+    checkIcosphere(ICO0);
+    checkIcosphere(ICO1);
+    checkIcosphere(ICO2);
+    checkEdges(CYLINDER);
+    checkEdges(CONE);
+    checkEdges(GRID);
+    checkEdges(TORUS);
+    checkEdges(GIZMO);
+
+    // Faces of every level are consistent with its edges
+    constexpr auto sphere = icosphere<1>();
+    for (std::size_t f = 0; f < sphere.faces.size(); f++) {
+        for (int k = 0; k < 3; k++) {
+            const auto& e = sphere.edges[sphere.face_edges[f][k]];
+            int a = sphere.faces[f][k], b = sphere.faces[f][(k + 1) % 3];
+            assert((e[0] == a && e[1] == b) || (e[0] == b && e[1] == a));
+        }
+    }
+
+    Wireframe3D wire(ICO2.vertices, ICO2.edges, 2.0f);
+    assert(wire.vertices.size() == 162 && wire.edges.size() == 480);
+    assert(std::abs(wire.radius - 1.0f) < 1e-4f);
+
+    std::cout << "primitives_test passed\n";
+    return 0;
+}
@@ -0,0 +1,86 @@
+/*
+StridedView / SphereView3D: fields of a caller's array of structs are read
+in place, and SphereView3D only re-projects what markDirty and the setters
+report as changed.
+*/
+
+#undef NDEBUG  // checks stay on in release builds
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <vector>
+#include <SFML/Graphics.hpp>
+#include <sfml-3d/3d_engine.hpp>
+
+struct Body {
+    float x, y, z;
+    float vx, vy, vz;
+    float mass;
+    sf::Color tint;
+};
+
+bool closeTo(float a, float b) { return std::abs(a - b) < 1e-3f; }
+
+int main() {
+    std::vector<Body> bodies;
+    for (int i = 0; i < 100; i++) {
+        float f = static_cast<float>(i);
+        bodies.push_back({f, 2 * f, 100 + f, -f, 0, 0, 1 + f / 10,
+                          sf::Color(static_cast<std::uint8_t>(i), 0, 0)});
+    }
+
+    StridedView<Float3> positions(&bodies[0].x, bodies.size(), sizeof(Body));
+    StridedView<float> masses(&bodies[0].mass, bodies.size(), sizeof(Body));
+    StridedView<sf::Color> tints(&bodies[0].tint, bodies.size(), sizeof(Body));
+    assert(positions.size() == 100 && !positions.empty());
+    for (std::size_t i = 0; i < bodies.size(); i++) {
+        Float3 p = positions[i];
+        assert(p.x == bodies[i].x && p.y == bodies[i].y && p.z == bodies[i].z);
+        assert(masses[i] == bodies[i].mass);
+        assert(tints[i] == bodies[i].tint);
+    }
+    assert(StridedView<float>().empty());
+
+    // Views see later writes without copying
+    bodies[3].y = -7.0f;
+    assert(positions[3].y == -7.0f);
+
+    sf::RenderWindow window;
+    Camera camera(window);
+    camera.cf = mat4::identity();
+
+    SphereView3D view(positions, masses, tints);
+    view.parallelThreshold = 16;
+    view.computeShape(window, camera);
+    const ProjectedPoints& projected = view.projected;
+    assert(projected.size() == bodies.size());
+
+    auto expectedX = [&](int i) {
+        return camera.FOV * bodies[i].x / bodies[i].z + window.getSize().x / 2.0f;
+    };
+    auto expectedSize = [&](int i, float r) { return camera.FOV * r / bodies[i].z; };
+    for (int i = 0; i < 100; i++) {
+        assert(closeTo(projected.position(i).x, expectedX(i)));
+        assert(closeTo(projected.pixelSize(i), expectedSize(i, bodies[i].mass)));
+    }
+
+    // Only dirty ranges are projected again while the view stays the same
+    bodies[5].x = 40.0f;
+    bodies[6].x = 40.0f;
+    view.markDirty(5, 6);
+    assert(view.update(window, camera));  // the range was pending
+    assert(closeTo(projected.position(5).x, expectedX(5)));
+    assert(!closeTo(projected.position(6).x, expectedX(6)));
+    assert(!view.update(window, camera));
+
+    // The shared radius is baked into the cache, so setRadius invalidates it
+    SphereView3D uniform(positions);
+    uniform.computeShape(window, camera);
+    uniform.setRadius(3.0f);
+    assert(uniform.update(window, camera));
+    assert(closeTo(uniform.projected.pixelSize(10), expectedSize(10, 3.0f)));
+
+    std::cout << "strided_view_test passed\n";
+    return 0;
+}
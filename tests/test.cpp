@@ -35,11 +35,10 @@ struct ObjectInfo {
 
 // Global object storage (for cleanup)
 std::vector<ObjectInfo> allObjects;
+ObjectPool3D objectPool;
 
 void cleanupObjects() {
-    for (auto& info : allObjects) {
-        delete info.obj;
-    }
+    objectPool.clear();
     allObjects.clear();
 }
 
@@ -74,13 +73,13 @@ void generateRandomObjects(Object3D_Collection& collection, int numObjects = 50)
             // Create sphere
             vec4 pos(pos_dist(gen), pos_dist(gen), pos_dist(gen));
             float radius = radius_dist(gen);
-            obj = new Sphere3D(pos, radius);
+            obj = objectPool.create<Sphere3D>(pos, radius);
         } else {
             // Create line
             vec4 start(pos_dist(gen), pos_dist(gen), pos_dist(gen));
             vec4 end(pos_dist(gen), pos_dist(gen), pos_dist(gen));
             float thickness = thickness_dist(gen);
-            obj = new Line3D(start, end, thickness);
+            obj = objectPool.create<Line3D>(start, end, thickness);
         }
 
         // Store object info
@@ -159,6 +158,9 @@ int main() {
     // Create object collection
     Object3D_Collection collection;
 
+    // Shaded sphere sprites, toggled with L
+    SphereAtlas sphereAtlas;
+
     // Generate initial random objects
     const int NUM_OBJECTS = 60;
     generateRandomObjects(collection, NUM_OBJECTS);
@@ -172,6 +174,7 @@ int main() {
     std::cout << "\n=== Depth Sorting Test ===" << std::endl;
     std::cout << "Press T to toggle depth sorting and see the difference!" << std::endl;
     std::cout << "Move around with WASD/QE to see sorting from different angles" << std::endl;
+    std::cout << "Press L to toggle lit sphere sprites" << std::endl;
     std::cout << "\nWhen sorting is OFF, you'll see visual artifacts:" << std::endl;
     std::cout << "- Far objects appearing in front of near ones" << std::endl;
     std::cout << "- Incorrect layering and overlaps\n" << std::endl;
@@ -201,6 +204,10 @@ int main() {
                     useColors = !useColors;
                     std::cout << "Colors: " << (useColors ? "ON" : "OFF") << std::endl;
                 }
+                else if (keyPressed->scancode == sf::Keyboard::Scan::L) {
+                    SPHERE_SPRITES = SPHERE_SPRITES ? nullptr : &sphereAtlas;
+                    std::cout << "Lit spheres: " << (SPHERE_SPRITES ? "ON" : "OFF") << std::endl;
+                }
                 else if (keyPressed->scancode == sf::Keyboard::Scan::Space) {
                     paused = !paused;
                     std::cout << "Animation: " << (paused ? "PAUSED" : "RUNNING") << std::endl;
@@ -226,20 +233,14 @@ int main() {
             collection.depthSort(camera);
         }
 
-        // Draw all objects
-        for (size_t i = 0; i < collection.c.size(); i++) {
-            auto& pair = collection.c[i];
-            Object3D* obj = pair.second;
-            int id = pair.first;
-            
-            // Find corresponding color
-            sf::Color color = sf::Color::White;
-            if (useColors && id < allObjects.size()) {
-                color = allObjects[id].color;
-            }
-            
-            obj->draw(window, camera, color);
-        }
+        // Clip all lines against the view frustum in one batch
+        collection.clipLines(window, camera);
+
+        // Draw all objects, batched into as few draw calls as possible
+        collection.draw(window, camera, [&](int id) {
+            if (useColors && id < allObjects.size()) return allObjects[id].color;
+            return sf::Color::White;
+        });
 
         /*
         // Draw reference axes at origin
@@ -0,0 +1,74 @@
+/*
+Wireframe3D / Mesh3D / Instance3D: every shared vertex is transformed once
+per view, edges are derived from triangles without duplicates, and drawing
+instances leaves the model's own cache alone.
+*/
+
+#undef NDEBUG  // checks stay on in release builds
+#include <cassert>
+#include <cmath>
+#include <iostream>
+#include <type_traits>
+#include <vector>
+#include <SFML/Graphics.hpp>
+#include <sfml-3d/3d_engine.hpp>
+
+// Edge objects point back at the wireframe, so it must stay put
+static_assert(!std::is_copy_constructible_v<Wireframe3D>);
+static_assert(!std::is_move_constructible_v<Wireframe3D>);
+static_assert(!std::is_copy_assignable_v<Wireframe3D>);
+static_assert(!std::is_move_assignable_v<Wireframe3D>);
+
+bool closeTo(const vec4& a, const vec4& b) {
+    return std::abs(a.x - b.x) < 1e-4f && std::abs(a.y - b.y) < 1e-4f &&
+           std::abs(a.z - b.z) < 1e-4f;
+}
+
+int main() {
+    // Unit cube: 8 shared vertices, 12 triangles, 18 distinct edges
+    std::vector<vec4> corners;
+    for (int i = 0; i < 8; i++) {
+        corners.push_back(vec4(i & 1 ? 1.0f : -1.0f, i & 2 ? 1.0f : -1.0f,
+                               i & 4 ? 1.0f : -1.0f));
+    }
+    std::vector<std::array<int, 3>> triangles = {
+        {0, 1, 3}, {0, 3, 2}, {4, 6, 7}, {4, 7, 5}, {0, 4, 5}, {0, 5, 1},
+        {2, 3, 7}, {2, 7, 6}, {0, 2, 6}, {0, 6, 4}, {1, 5, 7}, {1, 7, 3}};
+    Mesh3D cube(corners, triangles);
+    assert(cube.edges.size() == 18);
+    for (const auto& e : cube.edges) assert(e[0] < e[1]);
+
+    sf::RenderWindow window;
+    Camera camera(window);
+    camera.cf = mat4::translation(0.5f, -0.25f, -10.0f);
+
+    // One view-space copy per vertex, reused until the view changes
+    cube.prepare(window, camera);
+    mat4 inv = camera.cf.inverse_rigid();
+    assert(cube.projected.view.size() == corners.size());
+    for (std::size_t i = 0; i < corners.size(); i++) {
+        assert(closeTo(cube.projected.view[i], inv * corners[i]));
+    }
+    assert(!cube.projected.update(cube.vertices, window, camera, cube.thickness));
+    camera.cf = mat4::translation(0.0f, 0.0f, -12.0f);
+    assert(cube.projected.update(cube.vertices, window, camera, cube.thickness));
+
+    // Instances transform into the model's scratch, not its cache
+    InstanceSet3D set(&cube);
+    Instance3D& moved = set.add(mat4::translation(3.0f, 0.0f, 0.0f), sf::Color::Red);
+    set.update(camera);
+
+    mat4 expected = camera.cf.inverse_rigid() * moved.transform;
+    for (int k = 0; k < 16; k++) assert(std::abs(moved.modelview.m[k] - expected.m[k]) < 1e-4f);
+
+    moved.computeShape(window, camera);
+    assert(cube.projected.key.matches(window, camera));
+    for (std::size_t i = 0; i < corners.size(); i++) {
+        mat4 m = camera.cf.inverse_rigid();
+        assert(closeTo(cube.projected.view[i], m * corners[i]));
+        assert(closeTo(cube.instance_scratch.view[i], expected * corners[i]));
+    }
+
+    std::cout << "wireframe_test passed\n";
+    return 0;
+}